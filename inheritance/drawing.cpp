@@ -0,0 +1,134 @@
+#include "drawing.hpp"
+#include "parallel_shapes.hpp"
+#include <algorithm>
+#include <iterator>
+
+using namespace std;
+
+void Drawing::add(unique_ptr<IShape> shp)
+{
+    if (auto circle = dynamic_cast<Circle*>(shp.get()))
+        emplace<Circle>(*circle);
+    else if (auto rectangle = dynamic_cast<Rectangle*>(shp.get()))
+        emplace<Rectangle>(*rectangle);
+    else if (auto line = dynamic_cast<Line*>(shp.get()))
+        emplace<Line>(*line);
+    else if (auto polygon = dynamic_cast<Polygon*>(shp.get()))
+        emplace<Polygon>(std::move(*polygon));
+    else
+    {
+        other_ids_.push_back(refs_.size());
+        refs_.push_back(ShapeRef{ShapeKind::other, others_.size()});
+        index_.insert(BoundingBox{0, 0, -1, -1}); // not indexed - ids of the index stay equal to ids of shapes
+        others_.push_back(std::move(shp));
+    }
+}
+
+void Drawing::move(size_t id, int dx, int dy)
+{
+    const ShapeRef ref = refs_[id];
+    if (ref.kind == ShapeKind::other)
+    {
+        others_[ref.index]->move(dx, dy);
+        return;
+    }
+
+    store().visit(ref, [&](auto& shape) {
+        shape.move(dx, dy);
+        index_.update(id, bounding_box(shape));
+    });
+}
+
+ShapeBatch Drawing::batch() const
+{
+    ShapeBatch batch;
+    for (const ShapeRef& ref : refs_)
+        if (ref.kind != ShapeKind::other)
+            shapes().visit(ref, [&batch](const auto& shape) { batch.add(shape); });
+
+    return batch;
+}
+
+ShapeBatch& Drawing::translated_batch()
+{
+    if (!batch_is_current_)
+    {
+        batch_ = batch();
+        batch_is_current_ = true;
+    }
+
+    store_is_current_ = false; // shapes are moved when they are accessed
+    return batch_;
+}
+
+void Drawing::move_all(int dx, int dy)
+{
+    translated_batch().translate(dx, dy);
+    index_.translate(dx, dy); // O(1)
+
+    for(auto& shp : others_)
+        shp->move(dx, dy);
+}
+
+void Drawing::move_all(int dx, int dy, ThreadPool& pool)
+{
+    translated_batch().translate(dx, dy, pool);
+    index_.translate(dx, dy);
+
+    for(auto& shp : others_)
+        shp->move(dx, dy);
+}
+
+void Drawing::render() const
+{
+    for (size_t id = 0; id < refs_.size(); ++id)
+        visit(id, [](const auto& shape) { shape.draw(); });
+}
+
+void Drawing::render(Renderer& renderer) const
+{
+    for (size_t id = 0; id < refs_.size(); ++id)
+        visit(id, [&renderer](const auto& shape) { shape.draw(renderer); });
+}
+
+void Drawing::render(Renderer& renderer, ThreadPool& pool) const
+{
+    write_back(); // before shapes are read by threads of the pool
+
+    parallel_render(refs_, renderer, [this](const ShapeRef& ref, Renderer& r) {
+        if (ref.kind == ShapeKind::other)
+            others_[ref.index]->draw(r);
+        else
+            store_.visit(ref, [&r](const auto& shape) { shape.draw(r); });
+    }, pool);
+}
+
+void Drawing::render(const BoundingBox& viewport) const
+{
+    vector<size_t> ids = query(viewport);
+
+    vector<size_t> visible_ids; // shapes of other types are always drawn
+    visible_ids.reserve(ids.size() + other_ids_.size());
+    merge(ids.begin(), ids.end(), other_ids_.begin(), other_ids_.end(), back_inserter(visible_ids));
+
+    for (size_t id : visible_ids)
+        visit(id, [](const auto& shape) { shape.draw(); });
+}
+
+vector<size_t> Drawing::hit_test(const Point& pt) const
+{
+    vector<size_t> ids;
+    index_.hit_test(pt, ids);
+    sort(ids.begin(), ids.end());
+
+    return ids;
+}
+
+vector<size_t> Drawing::query(const BoundingBox& area) const
+{
+    vector<size_t> ids;
+    index_.query(area, ids);
+    sort(ids.begin(), ids.end());
+
+    return ids;
+}
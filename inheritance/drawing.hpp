@@ -0,0 +1,135 @@
+#ifndef DRAWING_HPP
+#define DRAWING_HPP
+
+#include "shape_batch.hpp"
+#include "shape_store.hpp"
+#include "shapes.hpp"
+#include "spatial_grid.hpp"
+#include "thread_pool.hpp"
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// Shapes of known types are stored by value in per-type arrays (ShapeStore) and
+// indexed by their bounding boxes (SpatialGrid); shapes of other types are owned
+// through IShape pointers and are not indexed. Shape ids are consecutive numbers
+// in the order of emplace() & add() - shapes are rendered in the order of ids
+// (later shapes are drawn over earlier ones); per-type arrays are iterated only by bulk moves.
+// move_all() translates coordinates kept in a ShapeBatch - they are written back to the shapes
+// when the shapes are accessed (const methods included, so a Drawing is not thread-safe).
+// Move shapes through Drawing - the index & the batch are not updated when shapes are modified
+// directly (e.g. through pointers to shapes() kept across calls of Drawing).
+class Drawing
+{
+    mutable ShapeStore store_;
+    SpatialGrid index_;
+    std::vector<ShapeRef> refs_;                  // refs_[id]
+    std::vector<std::unique_ptr<IShape>> others_; // shapes of other types - virtual dispatch
+    std::vector<size_t> other_ids_;               // ids of others_
+    ShapeBatch batch_;                            // coordinates translated by move_all()
+    bool batch_is_current_ = false;               // batch_ has the coordinates of store_
+    mutable bool store_is_current_ = true;        // false - translation of batch_ is not written back
+
+    void write_back() const
+    {
+        if (!store_is_current_)
+        {
+            batch_.write_back(store_);
+            store_is_current_ = true;
+        }
+    }
+
+    // shapes of the store may be modified by the caller
+    ShapeStore& store()
+    {
+        write_back();
+        batch_is_current_ = false;
+        return store_;
+    }
+
+    ShapeBatch& translated_batch();
+
+public:
+    explicit Drawing(int cell_size = 64) : index_{cell_size}
+    {}
+
+    template <typename TShape, typename... TArgs>
+    TShape& emplace(TArgs&&... args)
+    {
+        StableVector<TShape>& shapes = store().get<TShape>();
+        TShape& shape = shapes.emplace_back(std::forward<TArgs>(args)...);
+
+        refs_.push_back(ShapeRef{ShapeKindOf<TShape>::value, shapes.size() - 1});
+        index_.insert(bounding_box(shape));
+
+        return shape;
+    }
+
+    // shapes of known types are moved into the per-type arrays
+    void add(std::unique_ptr<IShape> shp);
+
+    size_t size() const
+    {
+        return refs_.size();
+    }
+
+    ShapeStore& shapes()
+    {
+        return store();
+    }
+
+    const ShapeStore& shapes() const
+    {
+        write_back();
+        return store_;
+    }
+
+    // f(shape) is called for the shape of concrete type (IShape for shapes added with add())
+    template <typename TFunction>
+    decltype(auto) visit(size_t id, TFunction f) const
+    {
+        const ShapeRef ref = refs_[id];
+        if (ref.kind == ShapeKind::other)
+            return f(static_cast<const IShape&>(*others_[ref.index]));
+
+        return shapes().visit(ref, f);
+    }
+
+    // empty box for shapes added with add()
+    BoundingBox bounding_box_of(size_t id) const
+    {
+        return index_.box(id);
+    }
+
+    void move(size_t id, int dx, int dy);
+
+    // copy of shapes of known types with coordinates in SoA arrays - for bulk translations;
+    // batch.render(renderer) gives the same output as render(renderer) without shapes added with add()
+    ShapeBatch batch() const;
+
+    void move_all(int dx, int dy);
+
+    // shapes of known types are translated by threads of the pool
+    void move_all(int dx, int dy, ThreadPool& pool);
+
+    // shapes in the order of ids
+    void render() const;
+
+    // the same text as render() - written to the sink of the renderer in batches
+    void render(Renderer& renderer) const;
+
+    // the same output as render(renderer) - chunks of shapes are drawn by threads of the pool
+    void render(Renderer& renderer, ThreadPool& pool) const;
+
+    // only shapes intersecting the viewport (and shapes added with add()) - in the order of render()
+    void render(const BoundingBox& viewport) const;
+
+    // ids of shapes with bounding boxes containing the point - ordered by ids
+    std::vector<size_t> hit_test(const Point& pt) const;
+
+    // ids of shapes with bounding boxes intersecting the area - ordered by ids
+    std::vector<size_t> query(const BoundingBox& area) const;
+};
+
+#endif // DRAWING_HPP
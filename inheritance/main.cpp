@@ -1,185 +1,30 @@
+#define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include "catch.hpp"
+#include "drawing.hpp"
+#include "parallel_shapes.hpp"
+#include "shape_batch.hpp"
+#include "raster.hpp"
+#include "render.hpp"
+#include "variant_shapes.hpp"
+#include "shapes.hpp"
+#include "span.hpp"
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <fstream>
 #include <iostream>
+#include <sstream>
 #include <string>
 #include <vector>
-#include <cassert>
 #include <memory>
+#include <memory_resource>
+#include <thread>
 
 using namespace std::literals;
 
-struct Point
-{
-    int x, y;
-
-    Point(int x = 0, int y = 0) : x{x}, y{y}
-    {}
-};
-
-std::ostream& operator<<(std::ostream& out, const Point& pt)
-{
-    out << "(" << pt.x << ", " << pt.y << ")";
-    return out;
-}
-
-class IShape
-{
-public:
-    virtual ~IShape() = default;
-    virtual void move(int dx, int dy) = 0;
-    virtual void draw() const = 0;
-};
-
-class Shape : public IShape
-{
-    Point coord_;
-public:
-    Shape(const Point& coord) : coord_{coord}
-    {}
-
-    Shape(int x = 0, int y = 0) : coord_{x, y}
-    {}
-
-    ~Shape() noexcept override
-    {
-        std::cout << "~Shape(" << coord_ << ")\n";
-    }
-
-    void move(int dx, int dy) override
-    {
-        coord_.x += dx;
-        coord_.y += dy;
-    }
-
-    const Point& coord() const
-    {
-        return coord_;
-    }
-};
-
-
-class Circle : public Shape
-{
-    int radius_;
-public:
-    Circle(int x = 0, int y = 0, int r = 0)
-        : Shape{x, y}, radius_{r}
-    {}
-
-    Circle(const Point& pt, int r) : Shape{pt}, radius_{r}
-    {}
-
-    ~Circle() noexcept override
-    {
-        std::cout << "~Circle(" << coord() << ")\n";
-    }
-
-    int radius() const
-    {
-        return radius_;
-    }
-
-    void draw() const override
-    {
-        std::cout << "Circle at " << coord() << " with r: " << radius_ << "\n";
-    }
-};
-
-
-class Rectangle : public Shape
-{
-    uint32_t width_;
-    uint32_t height_;
-public:
-    Rectangle(int x, int y, uint32_t w, uint32_t h)
-        : Shape{x, y}, width_{w}, height_{h}
-    {}
-
-    Rectangle(const Point& pt, uint32_t w, uint32_t h)
-        : Shape{pt}, width_{w}, height_{h}
-    {}
-
-    ~Rectangle() noexcept override
-    {
-        std::cout << "~Rectangle(" << coord()<< ")\n";
-    }
-
-    uint32_t width() const
-    {
-        return width_;
-    }
-
-    uint32_t height() const
-    {
-        return height_;
-    }
-
-    void draw() const override
-    {
-        std::cout << "Rectangle at " << coord()
-                  << " w: " << width_<< ", h: " << height_ << "\n";
-    }
-};
-
-class Line : public Shape
-{
-    Point end_;
-public:
-    Line(int x_start = 0, int y_start = 0, int x_end = 0, int y_end = 0)
-        : Shape{x_start, y_start}, end_{x_end, y_end}
-    {}
-
-    Line(const Point& start, const Point& end) : Shape{start}, end_{end}
-    {}
-
-    ~Line() override
-    {
-        std::cout << "~Line(" << coord() << ")\n";
-    }
-
-    void move(int dx, int dy) override
-    {
-        Shape::move(dx, dy); // call of method from base class
-
-        end_.x += dx;
-        end_.y += dy;
-    }
-
-    void draw() const override
-    {
-        std::cout << "Line from " << coord() << " to " << end_ << "\n";
-    }
-};
-
-class Polygon : public IShape
-{
-    std::vector<Point> points_;
-public:
-    Polygon(std::initializer_list<Point> pts)
-    {
-        for(const auto& pt : pts)
-        {
-            points_.push_back(pt);
-        }
-    }
-
-    void move(int dx, int dy) override
-    {
-        for(auto& pt : points_)
-        {
-            pt.x += dx;
-            pt.y += dy;
-        }
-    }
-
-    void draw() const override
-    {
-        std::cout << "Polygon: ";
-        for(const auto& pt : points_)
-            std::cout << pt << " ";
-        std::cout << "\n";
-    }
-};
-
-void draw_all(const std::vector<IShape*> shape_ptrs)
+void draw_all(Span<IShape* const> shape_ptrs)
 {
     for(auto shp_ptr : shape_ptrs)
     {
@@ -187,7 +32,7 @@ void draw_all(const std::vector<IShape*> shape_ptrs)
     }
 }
 
-void move_all(const std::vector<IShape*> shape_ptrs, int dx, int dy)
+void move_all(Span<IShape* const> shape_ptrs, int dx, int dy)
 {
     for(IShape* shp_ptr : shape_ptrs)
     {
@@ -195,7 +40,7 @@ void move_all(const std::vector<IShape*> shape_ptrs, int dx, int dy)
     }
 }
 
-void kill_em_all(std::vector<IShape*> shape_ptrs)
+void kill_em_all(Span<IShape* const> shape_ptrs)
 {
     for(IShape* ptr_shp : shape_ptrs)
         delete ptr_shp;
@@ -231,22 +76,6 @@ namespace WithRawPointers
     };
 }
 
-class Drawing
-{
-    std::vector<std::unique_ptr<IShape>> shapes_;
-public:
-    void add(std::unique_ptr<IShape> shp)
-    {
-        shapes_.push_back(std::move(shp));
-    }
-
-    void render() const
-    {
-        for(auto& shp : shapes_)
-            shp->draw();
-    }
-};
-
 void memory_leak_demo();
 
 void raw_pointer_memory_leak();
@@ -322,40 +151,103 @@ void casting_in_inheritance()
     }
 }
 
-int main()
+// text written to std::cout in the scope is stored in output
+class CaptureOutput
 {
-    {
-        //        Shape shp(100, 200);
-        //        shp.draw();
-        //        shp.move(20, 30);
-        //        shp.draw();
+    std::string& output_;
+    std::ostringstream out_;
+    std::streambuf* cout_buffer_;
+public:
+    explicit CaptureOutput(std::string& output)
+        : output_{output}, cout_buffer_{std::cout.rdbuf(out_.rdbuf())}
+    {}
 
-        Circle c(400, 500, 50);
-        c.draw();
-        c.move(20, 30);
-        c.draw();
-        assert(c.radius() == 50);
+    CaptureOutput(const CaptureOutput&) = delete;
+    CaptureOutput& operator=(const CaptureOutput&) = delete;
 
-        Point pt{50, 90};
-        Rectangle r(pt, 200, 50);
-        r.draw();
-        r.move(-10, 50);
-        r.draw();
+    ~CaptureOutput()
+    {
+        std::cout.rdbuf(cout_buffer_);
+        output_ = out_.str();
+    }
+};
+
+// n shapes of every type - types are interleaved
+Drawing make_drawing(int n)
+{
+    Drawing drw;
+    for (int i = 0; i < n; ++i)
+    {
+        drw.emplace<Circle>(i, i + 1, 5);
+        drw.emplace<Rectangle>(i, -i, 10, 20);
+        drw.emplace<Line>(i, i, i + 5, i + 7);
+        drw.emplace<Polygon>(std::initializer_list<Point>{{i, 0}, {0, i}, {i, i}});
+    }
 
-        Line l{400, 100, 440, 665};
+    return drw;
+}
 
-        std::cout << "\n---------------\n";
+// shapes print in their destructors - returns the number of destroyed Circles, Rectangles & Lines
+template <typename TDrawing>
+size_t destroy_shapes(TDrawing& drw)
+{
+    std::string output;
+    {
+        CaptureOutput capture{output};
+        drw = TDrawing{};
+    }
 
-        std::vector<IShape*> shape_ptrs = {&c, &r, &l};
-        draw_all(shape_ptrs);
+    return static_cast<size_t>(std::count(output.begin(), output.end(), '\n')) / 2; // ~Circle(...) & ~Shape(...)
+}
 
-        std::cout << "\n---------------\n";
-        move_all(shape_ptrs, 500, 400);
-        draw_all(shape_ptrs);
+template <typename TDrawing>
+std::string render_text(const TDrawing& drw)
+{
+    MemorySink memory;
+    {
+        Renderer renderer{memory};
+        drw.render(renderer);
     }
 
+    return memory.text();
+}
+
+TEST_CASE("shapes")
+{
+    //        Shape shp(100, 200);
+    //        shp.draw();
+    //        shp.move(20, 30);
+    //        shp.draw();
+
+    Circle c(400, 500, 50);
+    c.draw();
+    c.move(20, 30);
+    c.draw();
+    REQUIRE(c.radius() == 50);
+    REQUIRE(c.coord().x == 420);
+
+    Point pt{50, 90};
+    Rectangle r(pt, 200, 50);
+    r.draw();
+    r.move(-10, 50);
+    r.draw();
+
+    Line l{400, 100, 440, 665};
+
     std::cout << "\n---------------\n";
 
+    std::vector<IShape*> shape_ptrs = {&c, &r, &l};
+    draw_all(shape_ptrs);
+
+    std::cout << "\n---------------\n";
+    move_all(shape_ptrs, 500, 400);
+    draw_all(shape_ptrs);
+
+    REQUIRE(l.end().y == 1065);
+}
+
+TEST_CASE("shapes - owned by raw pointers")
+{
     std::vector<IShape*> album_cover = {
         new Circle(100, 200, 90),
         new Rectangle(200, 400, 100, 200),
@@ -367,8 +259,21 @@ int main()
 
     kill_em_all(album_cover);
 
-    std::cout << "\n---------------\n";
+    try
+    {
+        //memory_leak_demo();
+        //raw_pointer_memory_leak();
+    }
+    catch (...)
+    {
+    }
+
+    casting_in_inheritance();
+}
 
+TEST_CASE("Drawing")
+{
+    SECTION("shapes owned through IShape pointers")
     {
         Drawing drw;
 
@@ -380,22 +285,733 @@ int main()
 
         drw.render();
 
+        REQUIRE(drw.size() == 4);
+        REQUIRE(drw.shapes().size() == 4); // known types are moved into the per-type arrays
+
+        std::string output;
+        std::string text;
+        {
+            CaptureOutput capture{output};
+            text = render_text(drw);
+        }
+
+        REQUIRE(output.empty()); // only the sink of the renderer gets the output
+        REQUIRE(text == "Circle at (100, 200) with r: 90\n"
+                        "Rectangle at (200, 400) w: 100, h: 200\n"
+                        "Line from (100, 100) to (500, 600)\n"
+                        "Polygon: (100, 200) (200, 400) (300, 400) \n");
+
         //    Drawing backup = drw;
         //    backup.render();
     }
 
-    std::cout << "\n---------------\n";
+    SECTION("shapes stored by value in per-type arrays")
+    {
+        Drawing drw;
 
-    try
+        drw.emplace<Circle>(100, 200, 90);
+        drw.emplace<Rectangle>(200, 400, 100, 200);
+        drw.emplace<Line>(100, 100, 500, 600);
+        drw.emplace<Polygon>(std::initializer_list<Point>{{100, 200}, {200, 400}, {300, 400}});
+
+        drw.move_all(10, 20);
+        drw.render();
+
+        REQUIRE(drw.size() == 4);
+        REQUIRE(drw.shapes().get<Circle>()[0].coord().x == 110);
+        REQUIRE(drw.shapes().get<Polygon>()[0].points()[2].y == 420);
+    }
+
+    SECTION("shapes are constructed in place - never copied or relocated")
     {
-        //memory_leak_demo();
-        //raw_pointer_memory_leak();
+        std::string output;
+        Drawing drw;
+        {
+            CaptureOutput capture{output};
+            drw = make_drawing(5'000); // several chunks of every type
+            drw.move_all(1, 1);
+        }
+
+        REQUIRE(output.empty());
+        REQUIRE(destroy_shapes(drw) == 3 * 5'000u);
     }
-    catch (...)
+}
+
+TEST_CASE("Drawing - shapes of other types")
+{
+    // shape of a type unknown to Drawing - kept through IShape pointer
+    struct Star final : IShape
     {
+        Point center;
+
+        explicit Star(const Point& pt) : center{pt}
+        {}
+
+        void move(int dx, int dy) override
+        {
+            center.x += dx;
+            center.y += dy;
+        }
+
+        void draw() const override
+        {
+            std::cout << "Star at " << center << "\n";
+        }
+
+        void draw(Renderer& renderer) const override
+        {
+            renderer.circle(center, 1);
+        }
+    };
+
+    Drawing drw;
+    drw.emplace<Circle>(0, 0, 5);
+    drw.add(std::make_unique<Star>(Point{1'000, 1'000}));
+    drw.emplace<Line>(0, 0, 10, 10);
+
+    drw.move_all(5, 5);
+    drw.move(1, 1, 1);
+
+    REQUIRE(drw.size() == 3);
+    REQUIRE(drw.shapes().size() == 2);
+    REQUIRE(drw.hit_test(Point{1'006, 1'006}).empty()); // not indexed
+
+    std::string output;
+    {
+        CaptureOutput capture{output};
+        drw.render();
+        drw.render(BoundingBox{0, 0, 10, 10});
     }
 
-    casting_in_inheritance();
+    const std::string expected = "Circle at (5, 5) with r: 5\n"
+                                 "Star at (1006, 1006)\n"
+                                 "Line from (5, 5) to (15, 15)\n";
+    REQUIRE(output == expected + expected); // in the order of insertion - viewport always includes stars
 
-    std::cout << "\n---------------\n";
-}
\ No newline at end of file
+    ThreadPool pool{2};
+    MemorySink parallel;
+    {
+        Renderer renderer{parallel};
+        drw.render(renderer, pool);
+    }
+    REQUIRE(parallel.text() == render_text(drw));
+}
+
+TEST_CASE("Drawing - shapes are rendered in the order of insertion")
+{
+    ThreadPool pool{4};
+
+    Drawing drw;
+    drw.emplace<Rectangle>(0, 0, 100, 100);
+    drw.emplace<Circle>(50, 50, 20);
+    drw.emplace<Rectangle>(40, 40, 5, 5); // over the circle
+    drw.emplace<Line>(0, 0, 99, 99);
+
+    const std::string expected = "Rectangle at (0, 0) w: 100, h: 100\n"
+                                 "Circle at (50, 50) with r: 20\n"
+                                 "Rectangle at (40, 40) w: 5, h: 5\n"
+                                 "Line from (0, 0) to (99, 99)\n";
+
+    SECTION("text")
+    {
+        std::string output;
+        {
+            CaptureOutput capture{output};
+            drw.render();
+            drw.render(BoundingBox{0, 0, 100, 100});
+        }
+
+        REQUIRE(output == expected + expected);
+    }
+
+    SECTION("renderer")
+    {
+        MemorySink parallel;
+        {
+            Renderer renderer{parallel};
+            drw.render(renderer, pool);
+        }
+
+        REQUIRE(render_text(drw) == expected);
+        REQUIRE(parallel.text() == expected);
+    }
+
+    SECTION("overlapping pixels")
+    {
+        MemorySink memory;
+        {
+            Renderer renderer{memory};
+            drw.render(renderer);
+        }
+
+        const Palette palette;
+        Framebuffer frame{128, 128};
+        rasterize(memory.commands(), frame, palette);
+
+        REQUIRE(frame(10, 80) == palette.rectangle);
+        REQUIRE(frame(50, 65) == palette.circle);    // circle over the first rectangle
+        REQUIRE(frame(42, 44) == palette.rectangle); // second rectangle over the circle
+        REQUIRE(frame(60, 60) == palette.line);      // line over all of them
+    }
+}
+
+TEST_CASE("ShapeBatch - translation")
+{
+    ThreadPool pool{4};
+
+    const int n = 20'000; // shapes of every type - several chunks of points
+
+    Drawing drw = make_drawing(n);
+
+    ShapeBatch batch = drw.batch();
+    REQUIRE(batch.no_of_points() == 7u * n);
+
+    drw.move_all(3, -4);
+
+    SECTION("sequential")
+    {
+        batch.translate(3, -4);
+    }
+
+    SECTION("thread pool")
+    {
+        batch.translate(3, -4, pool);
+    }
+
+    for (int i = 0; i < n; i += 997)
+    {
+        REQUIRE(batch.circle(i).coord().x == drw.shapes().get<Circle>()[i].coord().x);
+        REQUIRE(batch.rectangle(i).coord().y == drw.shapes().get<Rectangle>()[i].coord().y);
+        REQUIRE(batch.line(i).end().y == drw.shapes().get<Line>()[i].end().y);
+        REQUIRE(batch.polygon(i).points()[1].x == drw.shapes().get<Polygon>()[i].points()[1].x);
+    }
+
+    MemorySink output;
+    {
+        Renderer renderer{output};
+        batch.render(renderer);
+    }
+    REQUIRE(output.text() == render_text(drw)); // the same order of shapes
+
+    batch.translate(-10, 10);
+    batch.write_back(drw.shapes());
+    REQUIRE(drw.shapes().get<Polygon>()[n - 1].points()[2].y == n - 1 - 4 + 10);
+    REQUIRE(render_text(drw) == render_text(batch));
+
+    REQUIRE(destroy_shapes(drw) == 3u * n);
+}
+
+TEST_CASE("Drawing - move_all translates the batch of coordinates")
+{
+    Drawing drw = make_drawing(1'000);
+    drw.add(std::make_unique<Circle>(0, 0, 1));
+
+    drw.move_all(1, 2);
+    drw.move_all(3, 4, default_thread_pool()); // only the batch is translated
+    drw.move(0, 10, 10);                       // written back before the shape is moved
+    drw.emplace<Line>(0, 0, 1, 1);
+    drw.move_all(1, 1);                        // batch is rebuilt
+
+    REQUIRE(drw.shapes().get<Circle>()[0].coord().x == 0 + 4 + 10 + 1);
+    REQUIRE(drw.shapes().get<Circle>()[1'000].coord().y == 0 + 6 + 1); // added with add()
+    REQUIRE(drw.shapes().get<Polygon>()[999].points()[0].x == 999 + 4 + 1);
+    REQUIRE(drw.shapes().get<Line>()[1'000].end().y == 1 + 1);
+    REQUIRE(drw.bounding_box_of(0).left == 0 + 4 + 10 + 1 - 5);
+
+    const Drawing& view = drw; // const access writes back the translation too
+    drw.move_all(-1, -1);
+    REQUIRE(view.shapes().get<Rectangle>()[7].coord().x == 7 + 4);
+
+    destroy_shapes(drw);
+}
+
+TEST_CASE("ShapeBatch - translation benchmark", "[.][benchmark]")
+{
+    Drawing drw = make_drawing(250'000);
+    ShapeBatch batch = drw.batch();
+
+    std::vector<IShape*> shape_ptrs;
+    drw.shapes().for_each([&shape_ptrs](IShape& shp) { shape_ptrs.push_back(&shp); });
+
+    BENCHMARK("move_all - virtual")
+    {
+        move_all(shape_ptrs, 3, -4);
+    };
+
+    BENCHMARK("ShapeBatch::translate")
+    {
+        batch.translate(3, -4);
+    };
+
+    BENCHMARK("ShapeBatch::translate - thread pool")
+    {
+        batch.translate(3, -4, default_thread_pool());
+    };
+
+    BENCHMARK("Drawing::move_all - translation of the batch")
+    {
+        drw.move_all(3, -4);
+    };
+
+    destroy_shapes(drw);
+}
+
+TEST_CASE("Drawing - spatial index")
+{
+    Drawing drw{50};
+    for (int y = 0; y < 100; ++y)
+        for (int x = 0; x < 100; ++x)
+        {
+            if ((x + y) % 2 == 0)
+                drw.emplace<Circle>(x * 20, y * 20, 5);
+            else
+                drw.emplace<Rectangle>(x * 20, y * 20, 8, 8);
+        }
+    drw.emplace<Line>(0, 0, 2000, 2000);
+
+    auto brute_force = [&drw](const BoundingBox& area) {
+        std::vector<size_t> ids;
+        for (size_t id = 0; id < drw.shapes().size(); ++id)
+            if (drw.bounding_box_of(id).intersects(area))
+                ids.push_back(id);
+        return ids;
+    };
+
+    const BoundingBox viewport{100, 100, 300, 250};
+    REQUIRE(drw.query(viewport) == brute_force(viewport));
+    REQUIRE(drw.hit_test(Point{205, 203}) == (std::vector<size_t>{1010, 10'000})); // circle & line
+
+    SECTION("moved shape is reindexed")
+    {
+        drw.move(1010, 1'000, 0); // index is updated incrementally
+        REQUIRE(drw.hit_test(Point{1203, 203}) == (std::vector<size_t>{1010, 1060, 10'000}));
+        REQUIRE(drw.hit_test(Point{205, 203}) == std::vector<size_t>{10'000});
+    }
+
+    SECTION("all shapes moved")
+    {
+        drw.move_all(-15, 30);
+        const BoundingBox moved_viewport{-500, 0, 150, 400};
+        REQUIRE(drw.query(moved_viewport) == brute_force(moved_viewport));
+    }
+
+    SECTION("only shapes in the viewport are rendered")
+    {
+        std::string output;
+        {
+            CaptureOutput capture{output};
+            drw.render(BoundingBox{0, 30, 10, 40});
+        }
+
+        REQUIRE(output == "Circle at (0, 40) with r: 5\n"
+                          "Line from (0, 0) to (2000, 2000)\n");
+    }
+
+    REQUIRE(destroy_shapes(drw) == 10'001u);
+}
+
+TEST_CASE("Variant::Drawing")
+{
+    Variant::Drawing drw;
+    drw.emplace<Circle>(100, 200, 90);
+    drw.emplace<Rectangle>(200, 400, 100, 200);
+    drw.add(Line{100, 100, 500, 600});
+    drw.add(Polygon{{100, 200}, {200, 400}, {300, 400}});
+
+    drw.move_all(10, 20);
+
+    REQUIRE(std::get<Line>(drw[2]).end().y == 620);
+    REQUIRE(std::get<Polygon>(drw[3]).points()[1].x == 210);
+
+    SECTION("the same text as Drawing with IShape")
+    {
+        Drawing expected_drawing;
+        expected_drawing.emplace<Circle>(110, 220, 90);
+        expected_drawing.emplace<Rectangle>(210, 420, 100, 200);
+        expected_drawing.emplace<Line>(110, 120, 510, 620);
+        expected_drawing.emplace<Polygon>(std::initializer_list<Point>{{110, 220}, {210, 420}, {310, 420}});
+
+        const std::string expected = render_text(expected_drawing);
+        REQUIRE(render_text(drw) == expected);
+
+        std::string output;
+        {
+            CaptureOutput capture{output};
+            drw.render();
+        }
+
+        REQUIRE(output == expected);
+    }
+}
+
+TEST_CASE("Variant::Drawing - move benchmark", "[.][benchmark]")
+{
+    const int n = 1'000'000;
+
+    std::vector<std::unique_ptr<IShape>> shapes;
+    Variant::Drawing variant_drawing;
+    shapes.reserve(n);
+
+    for (int i = 0; i < n; ++i) // types are interleaved
+    {
+        switch (i % 4)
+        {
+            case 0:
+                shapes.push_back(std::make_unique<Circle>(i, i, 10));
+                variant_drawing.emplace<Circle>(i, i, 10);
+                break;
+            case 1:
+                shapes.push_back(std::make_unique<Rectangle>(i, i, 10, 20));
+                variant_drawing.emplace<Rectangle>(i, i, 10, 20);
+                break;
+            case 2:
+                shapes.push_back(std::make_unique<Line>(i, i, i + 10, i + 20));
+                variant_drawing.emplace<Line>(i, i, i + 10, i + 20);
+                break;
+            default:
+                shapes.push_back(std::make_unique<Polygon>(std::initializer_list<Point>{{i, 0}, {0, i}, {i, i}}));
+                variant_drawing.emplace<Polygon>(std::initializer_list<Point>{{i, 0}, {0, i}, {i, i}});
+        }
+    }
+
+    BENCHMARK("IShape (virtual)")
+    {
+        for (auto& shp : shapes)
+            shp->move(1, -1);
+    };
+
+    BENCHMARK("std::variant (visit)")
+    {
+        variant_drawing.move_all(1, -1);
+    };
+
+    destroy_shapes(shapes);
+    destroy_shapes(variant_drawing);
+}
+
+TEST_CASE("Renderer - sinks")
+{
+    Drawing drw;
+    drw.emplace<Circle>(100, 200, 90);
+    drw.emplace<Rectangle>(200, 400, 100, 200);
+    drw.emplace<Line>(100, 100, 500, 600);
+    drw.emplace<Polygon>(std::initializer_list<Point>{{100, 200}, {200, 400}, {300, 400}});
+
+    std::string expected;
+    {
+        CaptureOutput capture{expected};
+        drw.render();
+    }
+
+    SECTION("MemorySink")
+    {
+        MemorySink memory;
+        {
+            Renderer renderer{memory, 8}; // small buffer - several batches
+            drw.render(renderer);
+        }
+        REQUIRE(memory.text() == expected);
+    }
+
+    SECTION("TextSink")
+    {
+        std::ostringstream out;
+        {
+            TextSink text{out};
+            Renderer renderer{text};
+            drw.render(renderer);
+        }
+        REQUIRE(out.str() == expected);
+    }
+}
+
+TEST_CASE("Renderer - sinks benchmark", "[.][benchmark]")
+{
+    Drawing drw = make_drawing(250'000);
+
+    std::ofstream null_stream{"/dev/null"};
+
+    BENCHMARK("draw() - std::cout")
+    {
+        std::streambuf* cout_buffer = std::cout.rdbuf(null_stream.rdbuf());
+        drw.render();
+        std::cout.rdbuf(cout_buffer);
+    };
+
+    BENCHMARK("Renderer - FileSink")
+    {
+        FileSink file{"/dev/null"};
+        Renderer renderer{file};
+        drw.render(renderer);
+    };
+
+    destroy_shapes(drw);
+}
+
+TEST_CASE("rasterization")
+{
+    Drawing drw;
+    drw.emplace<Circle>(100, 200, 90);
+    drw.emplace<Rectangle>(200, 400, 100, 200);
+    drw.emplace<Line>(100, 100, 500, 600);
+    drw.emplace<Polygon>(std::initializer_list<Point>{{100, 200}, {200, 400}, {300, 400}});
+
+    MemorySink memory;
+    {
+        Renderer renderer{memory};
+        drw.render(renderer);
+    }
+
+    const Palette palette;
+    const Color background{0, 0, 0, 255};
+
+    Framebuffer serial{640, 640, background};
+    rasterize(memory.commands(), serial, palette);
+
+    REQUIRE(serial(100, 200) == palette.circle);
+    REQUIRE(serial(100, 110) == palette.circle); // top of the circle
+    REQUIRE(serial(100, 109) == background);
+    REQUIRE(serial(299, 599) == palette.rectangle); // [x, x + w) x [y, y + h)
+    REQUIRE(serial(300, 599) == background);
+    REQUIRE(serial(100, 100) == palette.line);
+    REQUIRE(serial(500, 600) == palette.line);
+    REQUIRE(serial(200, 380) == palette.polygon);
+    REQUIRE(serial(639, 639) == background);
+
+    SECTION("tiles rasterized in parallel - the same pixels regardless of the number of threads & tile size")
+    {
+        Framebuffer parallel{640, 640, background};
+        rasterize(memory.commands(), parallel, palette, 4, 16);
+        REQUIRE(parallel.pixels() == serial.pixels());
+    }
+
+    SECTION("RasterSink")
+    {
+        Framebuffer streamed{640, 640, background};
+        {
+            RasterSink sink{streamed, palette, 2};
+            Renderer renderer{sink, 8}; // several batches
+            drw.render(renderer);
+        }
+        REQUIRE(streamed.pixels() == serial.pixels());
+    }
+
+    SECTION("lines with extreme coordinates")
+    {
+        MemorySink lines;
+        {
+            Renderer renderer{lines};
+            renderer.line(Point{INT_MIN, INT_MIN}, Point{INT_MAX, INT_MAX}); // diagonal through (0, 0)
+            renderer.line(Point{600, INT_MIN}, Point{601, INT_MAX});         // x == 601 for y >= 0
+        }
+
+        Framebuffer extreme{640, 640, background};
+        rasterize(lines.commands(), extreme, palette);
+
+        for (int i = 0; i < 640; i += 71)
+        {
+            REQUIRE(extreme(i, i) == palette.line);
+            REQUIRE(extreme(601, i) == palette.line);
+            REQUIRE(extreme(600, i) == background);
+        }
+        REQUIRE(extreme(1, 0) == background);
+
+        Framebuffer tiled{640, 640, background};
+        rasterize(lines.commands(), tiled, palette, 4, 16);
+        REQUIRE(tiled.pixels() == extreme.pixels());
+    }
+
+    SECTION("raw RGBA bytes")
+    {
+        std::ostringstream raw;
+        serial.write_raw(raw);
+        REQUIRE(raw.str().size() == 640u * 640u * 4u);
+    }
+}
+
+TEST_CASE("rasterization benchmark", "[.][benchmark]")
+{
+    const int n = 25'000; // shapes of every type
+    const int width = 1920, height = 1080;
+    MemorySink scene;
+    {
+        Renderer renderer{scene};
+        for (int i = 0; i < n; ++i)
+        {
+            const int x = static_cast<int>((i * 7919LL) % width);
+            const int y = static_cast<int>((i * 104729LL) % height);
+            renderer.circle(Point{x, y}, 5 + i % 40);
+            renderer.rectangle(Point{y, x % height}, 10 + i % 60, 10 + i % 30);
+            renderer.line(Point{x, y}, Point{(x + 200) % width, (y + 150) % height});
+            const Point triangle[] = {{x, y}, {x + 50, y + 10}, {x + 20, y + 60}};
+            renderer.polygon(triangle, 3);
+        }
+    }
+
+    const Palette palette;
+    const size_t no_of_threads = std::max(1u, std::thread::hardware_concurrency());
+    Framebuffer frames[2] = {Framebuffer{width, height}, Framebuffer{width, height}};
+
+    BENCHMARK("rasterize - 1 thread")
+    {
+        rasterize(scene.commands(), frames[0], palette, 1);
+    };
+
+    BENCHMARK("rasterize - all threads")
+    {
+        rasterize(scene.commands(), frames[1], palette, no_of_threads);
+    };
+
+    REQUIRE(frames[0].pixels() == frames[1].pixels());
+}
+
+// polygons are loaded & moved 10 times
+template <typename TPolygons, typename TLoad>
+void load_and_move_polygons(TPolygons& polygons, int n, TLoad load)
+{
+    polygons.reserve(n);
+    for (int i = 0; i < n; ++i)
+        load(polygons, i);
+
+    for (int k = 0; k < 10; ++k)
+        for (auto& polygon : polygons)
+            for (auto& pt : polygon)
+            {
+                pt.x += 1;
+                pt.y -= 1;
+            }
+}
+
+TEST_CASE("Polygon - storage of points")
+{
+    Polygon triangle{{0, 0}, {10, 0}, {0, 10}};
+    REQUIRE(triangle.points().is_inline());
+
+    std::pmr::monotonic_buffer_resource arena;
+    Polygon first{{{0, 0}, {1, 0}, {2, 1}, {2, 2}, {1, 3}, {0, 2}}, &arena};
+    Polygon second{{{5, 5}, {6, 5}, {7, 6}, {7, 7}, {6, 8}}, &arena};
+    REQUIRE_FALSE(first.points().is_inline());
+    REQUIRE(second.points().data() == first.points().data() + first.points().size()); // packed in the arena
+
+    ShapeStore store; // points of polygons constructed in the store are allocated from the arena
+    for (int i = 0; i < 100; ++i)
+        store.emplace<Polygon>(std::initializer_list<Point>{{i, 0}, {i, 1}, {i, 2}, {i, 3}, {i, 4}}, &arena);
+    store.move_all(1, 1);
+    REQUIRE(store.get<Polygon>()[42].points()[4].x == 43);
+    REQUIRE(store.get<Polygon>()[42].points()[4].y == 5);
+    REQUIRE(store.get<Polygon>()[42].points().resource() == &arena);
+}
+
+TEST_CASE("Polygon - storage of points benchmark", "[.][benchmark]")
+{
+    const int n = 500'000;
+
+    for (int no_of_points : {3, 6})
+    {
+        const std::vector<Point> points(no_of_points, Point{1, 2});
+
+        BENCHMARK("std::vector<Point> - " + std::to_string(no_of_points) + " points")
+        {
+            std::vector<std::vector<Point>> polygons; // one allocation per polygon
+            load_and_move_polygons(polygons, n, [&points](auto& polygons, int) {
+                polygons.emplace_back(points.begin(), points.end());
+            });
+            return polygons.size();
+        };
+
+        BENCHMARK("Polygon::Points - " + std::to_string(no_of_points) + " points")
+        {
+            std::vector<Polygon::Points> polygons;
+            load_and_move_polygons(polygons, n, [&points](auto& polygons, int) {
+                polygons.emplace_back(points.begin(), points.end());
+            });
+            return polygons.size();
+        };
+
+        BENCHMARK("Polygon::Points - arena - " + std::to_string(no_of_points) + " points")
+        {
+            std::pmr::monotonic_buffer_resource polygon_arena;
+            std::vector<Polygon::Points> polygons;
+            load_and_move_polygons(polygons, n, [&points, &polygon_arena](auto& polygons, int) {
+                polygons.emplace_back(points.begin(), points.end(), &polygon_arena);
+            });
+            return polygons.size();
+        };
+    }
+}
+
+TEST_CASE("Drawing - parallel move & render")
+{
+    ThreadPool pool{4};
+
+    const int n = 20'000; // shapes of every type - several chunks
+
+    Drawing sequential = make_drawing(n);
+    Drawing parallel = make_drawing(n);
+
+    sequential.move_all(3, -4);
+    parallel.move_all(3, -4, pool);
+
+    MemorySink parallel_output;
+    {
+        Renderer renderer{parallel_output};
+        parallel.render(renderer, pool);
+    }
+    REQUIRE(parallel_output.text() == render_text(sequential)); // merged in the order of shapes
+
+    std::vector<IShape*> shape_ptrs;
+    parallel.shapes().for_each([&shape_ptrs](IShape& shp) { shape_ptrs.push_back(&shp); });
+
+    SECTION("draw_all")
+    {
+        MemorySink expected, span_output;
+        {
+            Renderer renderer{expected};
+            for (IShape* shp : shape_ptrs)
+                shp->draw(renderer);
+        }
+        {
+            Renderer renderer{span_output};
+            draw_all(shape_ptrs, renderer, pool);
+        }
+        REQUIRE(span_output.text() == expected.text());
+    }
+
+    SECTION("move_all")
+    {
+        move_all(shape_ptrs, -3, 4, pool);
+        REQUIRE(parallel.shapes().get<Line>()[n - 1].end().y == n - 1 + 7);
+        REQUIRE(parallel.shapes().get<Polygon>()[0].points()[1].y == 0);
+    }
+
+    REQUIRE(destroy_shapes(sequential) + destroy_shapes(parallel) == 6u * n);
+}
+
+TEST_CASE("Drawing - parallel move & render benchmark", "[.][benchmark]")
+{
+    ThreadPool& workers = default_thread_pool();
+
+    Drawing drw = make_drawing(250'000);
+
+    std::vector<IShape*> shape_ptrs;
+    drw.shapes().for_each([&shape_ptrs](IShape& shp) { shape_ptrs.push_back(&shp); });
+
+    BENCHMARK("move & render - sequential")
+    {
+        FileSink file{"/dev/null"};
+        Renderer renderer{file};
+        move_all(shape_ptrs, 1, 1);
+        for (IShape* shp : shape_ptrs)
+            shp->draw(renderer);
+    };
+
+    BENCHMARK("move & render - thread pool")
+    {
+        FileSink file{"/dev/null"};
+        Renderer renderer{file};
+        move_all(shape_ptrs, 1, 1, workers);
+        draw_all(shape_ptrs, renderer, workers);
+    };
+
+    destroy_shapes(drw);
+}
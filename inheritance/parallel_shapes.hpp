@@ -0,0 +1,69 @@
+#ifndef PARALLEL_SHAPES_HPP
+#define PARALLEL_SHAPES_HPP
+
+#include "render.hpp"
+#include "shapes.hpp"
+#include "span.hpp"
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+constexpr size_t min_shapes_per_task = 16 * 1024;
+
+// f(shape) is called for every shape - shapes are split into chunks processed by threads of the pool
+template <typename TShapes, typename TFunction>
+void parallel_for_each(TShapes& shapes, TFunction f, ThreadPool& pool = default_thread_pool(),
+                       size_t min_chunk_size = min_shapes_per_task)
+{
+    parallel_for(shapes.size(), [&shapes, &f](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i)
+            f(shapes[i]);
+    }, pool, min_chunk_size);
+}
+
+// draw(shape, renderer) is called for every shape - every chunk of shapes is drawn by a task into
+// its own command buffer; buffers are submitted to the renderer in the order of shapes, so the output
+// is the same as from the sequential loop.
+template <typename TShapes, typename TDraw>
+void parallel_render(const TShapes& shapes, Renderer& renderer, TDraw draw,
+                     ThreadPool& pool = default_thread_pool(), size_t min_chunk_size = min_shapes_per_task)
+{
+    const size_t count = shapes.size();
+    const size_t no_of_chunks = std::min(pool.size(), count / std::max<size_t>(min_chunk_size, 1));
+
+    if (no_of_chunks <= 1)
+    {
+        for (size_t i = 0; i < count; ++i)
+            draw(shapes[i], renderer);
+        return;
+    }
+
+    const size_t chunk_size = (count + no_of_chunks - 1) / no_of_chunks;
+    std::vector<MemorySink> chunks(no_of_chunks);
+
+    parallel_for(no_of_chunks, [&](size_t first_chunk, size_t last_chunk) {
+        for (size_t chunk = first_chunk; chunk < last_chunk; ++chunk)
+        {
+            Renderer chunk_renderer{chunks[chunk]};
+            for (size_t i = chunk * chunk_size; i < std::min(count, (chunk + 1) * chunk_size); ++i)
+                draw(shapes[i], chunk_renderer);
+        }
+    }, pool, 1);
+
+    for (const auto& chunk : chunks)
+        renderer.submit(chunk.commands());
+}
+
+// parallel versions of draw_all & move_all
+inline void draw_all(Span<IShape* const> shape_ptrs, Renderer& renderer, ThreadPool& pool)
+{
+    parallel_render(shape_ptrs, renderer, [](const IShape* shp, Renderer& r) { shp->draw(r); }, pool);
+}
+
+inline void move_all(Span<IShape* const> shape_ptrs, int dx, int dy, ThreadPool& pool)
+{
+    parallel_for_each(shape_ptrs, [dx, dy](IShape* shp) { shp->move(dx, dy); }, pool);
+}
+
+#endif // PARALLEL_SHAPES_HPP
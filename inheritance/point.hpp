@@ -0,0 +1,43 @@
+#ifndef POINT_HPP
+#define POINT_HPP
+
+#include <iostream>
+
+struct Point
+{
+    int x, y;
+
+    Point(int x = 0, int y = 0) : x{x}, y{y}
+    {}
+};
+
+inline std::ostream& operator<<(std::ostream& out, const Point& pt)
+{
+    out << "(" << pt.x << ", " << pt.y << ")";
+    return out;
+}
+
+// axis-aligned box - coordinates are inclusive
+struct BoundingBox
+{
+    int left, top, right, bottom;
+
+    bool empty() const
+    {
+        return left > right || top > bottom;
+    }
+
+    bool contains(const Point& pt) const
+    {
+        return left <= pt.x && pt.x <= right && top <= pt.y && pt.y <= bottom;
+    }
+
+    // empty boxes intersect nothing
+    bool intersects(const BoundingBox& other) const
+    {
+        return !empty() && !other.empty()
+            && left <= other.right && other.left <= right && top <= other.bottom && other.top <= bottom;
+    }
+};
+
+#endif // POINT_HPP
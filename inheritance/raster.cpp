@@ -0,0 +1,389 @@
+#include "raster.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <thread>
+
+using namespace std;
+
+namespace
+{
+    constexpr BoundingBox empty_box{0, 0, -1, -1}; // intersects nothing
+
+    int clamp_to_int(int64_t value)
+    {
+        return static_cast<int>(clamp<int64_t>(value, numeric_limits<int>::min(), numeric_limits<int>::max()));
+    }
+
+    BoundingBox make_box(int64_t left, int64_t top, int64_t right, int64_t bottom)
+    {
+        return BoundingBox{clamp_to_int(left), clamp_to_int(top), clamp_to_int(right), clamp_to_int(bottom)};
+    }
+
+    BoundingBox intersection(const BoundingBox& a, const BoundingBox& b)
+    {
+        return BoundingBox{max(a.left, b.left), max(a.top, b.top), min(a.right, b.right), min(a.bottom, b.bottom)};
+    }
+
+    // pixels that may be touched by commands
+    BoundingBox pixel_box(const Point& center, int radius)
+    {
+        if (radius < 0)
+            return empty_box;
+
+        return make_box(int64_t{center.x} - radius, int64_t{center.y} - radius,
+                        int64_t{center.x} + radius, int64_t{center.y} + radius);
+    }
+
+    BoundingBox pixel_box(const Point& corner, uint32_t width, uint32_t height)
+    {
+        if (width == 0 || height == 0)
+            return empty_box;
+
+        return make_box(corner.x, corner.y, int64_t{corner.x} + width - 1, int64_t{corner.y} + height - 1);
+    }
+
+    BoundingBox pixel_box(const Point& start, const Point& end)
+    {
+        return BoundingBox{min(start.x, end.x), min(start.y, end.y), max(start.x, end.x), max(start.y, end.y)};
+    }
+
+    BoundingBox pixel_box(const CommandBuffer::Points& points)
+    {
+        if (points.size() < 3)
+            return empty_box;
+
+        BoundingBox box{points[0].x, points[0].y, points[0].x, points[0].y};
+        for (size_t i = 1; i < points.size(); ++i)
+        {
+            const Point pt = points[i];
+            box.left = min(box.left, pt.x);
+            box.top = min(box.top, pt.y);
+            box.right = max(box.right, pt.x);
+            box.bottom = max(box.bottom, pt.y);
+        }
+
+        return box;
+    }
+
+    // steps k (0 <= k <= |d_major|) of a line with the major coordinate in [clip_first, clip_last]
+    pair<int64_t, int64_t> line_steps(int64_t major, int64_t d_major, int clip_first, int clip_last)
+    {
+        const int64_t k_first = d_major < 0 ? major - clip_last : clip_first - major;
+        const int64_t k_last = d_major < 0 ? major - clip_first : clip_last - major;
+
+        return {max<int64_t>(k_first, 0), min(k_last, abs(d_major))};
+    }
+
+    struct LineOffset
+    {
+        int64_t offset; // ceil((2 * a_minor * k - a_major) / (2 * a_major))
+        int64_t error;  // a_minor * k - a_major * offset - in (-a_major / 2, a_major / 2]
+    };
+
+    // offset of the minor coordinate at step k of Bresenham along the major axis (0 <= k <= a_major);
+    // a_minor * k < 2^64 for any int end points, so the product is exact in uint64_t
+    LineOffset line_offset(int64_t a_major, int64_t a_minor, int64_t k)
+    {
+        const uint64_t product = static_cast<uint64_t>(a_minor) * static_cast<uint64_t>(k);
+        const int64_t quotient = static_cast<int64_t>(product / static_cast<uint64_t>(a_major));
+        const int64_t remainder = static_cast<int64_t>(product % static_cast<uint64_t>(a_major));
+
+        if (2 * remainder > a_major)
+            return LineOffset{quotient + 1, remainder - a_major};
+
+        return LineOffset{quotient, remainder};
+    }
+
+    // copies every command to command buffers of all tiles it overlaps
+    class TileBinner
+    {
+        BoundingBox bounds_;
+        int tile_size_;
+        int columns_;
+        vector<CommandBuffer>& tiles_;
+    public:
+        TileBinner(const BoundingBox& bounds, int tile_size, int columns, vector<CommandBuffer>& tiles)
+            : bounds_{bounds}, tile_size_{tile_size}, columns_{columns}, tiles_{tiles}
+        {}
+
+        void circle(const Point& center, int radius)
+        {
+            bin(pixel_box(center, radius), [&](CommandBuffer& tile) { tile.circle(center, radius); });
+        }
+
+        void rectangle(const Point& corner, uint32_t width, uint32_t height)
+        {
+            bin(pixel_box(corner, width, height), [&](CommandBuffer& tile) { tile.rectangle(corner, width, height); });
+        }
+
+        // only tiles crossed by the line - not all tiles of its bounding box
+        void line(const Point& start, const Point& end)
+        {
+            const BoundingBox visible = intersection(pixel_box(start, end), bounds_);
+            if (visible.empty())
+                return;
+
+            auto append = [&](CommandBuffer& tile) { tile.line(start, end); };
+
+            const int64_t dx = int64_t{end.x} - start.x;
+            const int64_t dy = int64_t{end.y} - start.y;
+
+            if (dx == 0 || dy == 0)
+            {
+                bin(visible, append);
+            }
+            else if (abs(dx) >= abs(dy))
+            {
+                for (int column = visible.left / tile_size_; column <= visible.right / tile_size_; ++column)
+                {
+                    const int left = max(column * tile_size_, visible.left);
+                    const int right = min(column * tile_size_ + tile_size_ - 1, visible.right);
+                    const auto [top, bottom] = line_span(start.x, start.y, dx, dy, left, right);
+                    bin(BoundingBox{left, max(top, visible.top), right, min(bottom, visible.bottom)}, append);
+                }
+            }
+            else
+            {
+                for (int row = visible.top / tile_size_; row <= visible.bottom / tile_size_; ++row)
+                {
+                    const int top = max(row * tile_size_, visible.top);
+                    const int bottom = min(row * tile_size_ + tile_size_ - 1, visible.bottom);
+                    const auto [left, right] = line_span(start.y, start.x, dy, dx, top, bottom);
+                    bin(BoundingBox{max(left, visible.left), top, min(right, visible.right), bottom}, append);
+                }
+            }
+        }
+
+        void polygon(const CommandBuffer::Points& points)
+        {
+            bin(pixel_box(points), [&](CommandBuffer& tile) { tile.polygon(points); });
+        }
+
+    private:
+        // range of the minor coordinate for the major coordinate in [clip_first, clip_last]
+        static pair<int, int> line_span(int64_t major, int64_t minor, int64_t d_major, int64_t d_minor,
+                                        int clip_first, int clip_last)
+        {
+            const auto [k_first, k_last] = line_steps(major, d_major, clip_first, clip_last);
+            const int64_t step_minor = d_minor < 0 ? -1 : 1;
+            const int64_t first = minor + step_minor * line_offset(abs(d_major), abs(d_minor), k_first).offset;
+            const int64_t last = minor + step_minor * line_offset(abs(d_major), abs(d_minor), k_last).offset;
+
+            return {clamp_to_int(min(first, last)), clamp_to_int(max(first, last))};
+        }
+
+        template <typename TAppend>
+        void bin(const BoundingBox& box, TAppend append)
+        {
+            const BoundingBox visible = intersection(box, bounds_);
+            if (visible.empty())
+                return;
+
+            for (int row = visible.top / tile_size_; row <= visible.bottom / tile_size_; ++row)
+                for (int column = visible.left / tile_size_; column <= visible.right / tile_size_; ++column)
+                    append(tiles_[static_cast<size_t>(row) * columns_ + column]);
+        }
+    };
+}
+
+Framebuffer::Framebuffer(int width, int height, Color background)
+    : width_{max(width, 0)}, height_{max(height, 0)},
+      pixels_(static_cast<size_t>(width_) * height_, background)
+{}
+
+void Framebuffer::clear(Color color)
+{
+    fill(pixels_.begin(), pixels_.end(), color);
+}
+
+void Framebuffer::write_raw(ostream& out) const
+{
+    out.write(reinterpret_cast<const char*>(pixels_.data()), static_cast<streamsize>(pixels_.size() * sizeof(Color)));
+}
+
+Rasterizer::Rasterizer(Framebuffer& framebuffer, const BoundingBox& clip, const Palette& palette)
+    : framebuffer_{framebuffer}, clip_{intersection(clip, framebuffer.bounds())}, palette_{palette}
+{}
+
+void Rasterizer::span(int y, int x_first, int x_last, Color color)
+{
+    if (y < clip_.top || y > clip_.bottom)
+        return;
+
+    x_first = max(x_first, clip_.left);
+    x_last = min(x_last, clip_.right);
+
+    if (x_first <= x_last)
+        fill_n(framebuffer_.row(y) + x_first, x_last - x_first + 1, color);
+}
+
+void Rasterizer::circle(const Point& center, int radius)
+{
+    if (!pixel_box(center, radius).intersects(clip_))
+        return;
+
+    // every step of the midpoint algorithm gives spans of rows center.y +- y (width x) and
+    // center.y +- x (width y) - the latter only for the last (widest) y before x changes
+    int64_t x = radius, y = 0;
+    int64_t error = 1 - x;
+
+    while (x >= y)
+    {
+        span(clamp_to_int(center.y + y), clamp_to_int(center.x - x), clamp_to_int(center.x + x), palette_.circle);
+        span(clamp_to_int(center.y - y), clamp_to_int(center.x - x), clamp_to_int(center.x + x), palette_.circle);
+
+        if (error >= 0 || x == y)
+        {
+            span(clamp_to_int(center.y + x), clamp_to_int(center.x - y), clamp_to_int(center.x + y), palette_.circle);
+            span(clamp_to_int(center.y - x), clamp_to_int(center.x - y), clamp_to_int(center.x + y), palette_.circle);
+        }
+
+        ++y;
+        if (error < 0)
+        {
+            error += 2 * y + 1;
+        }
+        else
+        {
+            --x;
+            error += 2 * (y - x) + 1;
+        }
+    }
+}
+
+void Rasterizer::rectangle(const Point& corner, uint32_t width, uint32_t height)
+{
+    const BoundingBox box = intersection(pixel_box(corner, width, height), clip_);
+
+    for (int y = box.top; y <= box.bottom && box.left <= box.right; ++y)
+        fill_n(framebuffer_.row(y) + box.left, box.right - box.left + 1, palette_.rectangle);
+}
+
+// Bresenham along the major axis - only steps with the major coordinate in [clip_first, clip_last]
+// are traced; the state of the first of them is computed directly
+template <typename TPlot>
+void Rasterizer::trace_line(int64_t major, int64_t minor, int64_t d_major, int64_t d_minor,
+                            int clip_first, int clip_last, TPlot plot)
+{
+    const int64_t a_major = abs(d_major);
+    const int64_t a_minor = abs(d_minor);
+    const int64_t step_major = d_major < 0 ? -1 : 1;
+    const int64_t step_minor = d_minor < 0 ? -1 : 1;
+
+    if (a_major == 0)
+    {
+        plot(major, minor);
+        return;
+    }
+
+    const auto [k_first, k_last] = line_steps(major, d_major, clip_first, clip_last);
+    const LineOffset first = line_offset(a_major, a_minor, k_first);
+    int64_t offset = first.offset;
+    int64_t decision = 2 * (a_minor + first.error) - a_major; // 2 * a_minor * (k + 1) - a_major - 2 * a_major * offset
+
+    for (int64_t k = k_first; k <= k_last; ++k)
+    {
+        plot(major + step_major * k, minor + step_minor * offset);
+
+        if (decision > 0)
+        {
+            ++offset;
+            decision -= 2 * a_major;
+        }
+        decision += 2 * a_minor;
+    }
+}
+
+void Rasterizer::line(const Point& start, const Point& end)
+{
+    if (!pixel_box(start, end).intersects(clip_))
+        return;
+
+    const int64_t dx = int64_t{end.x} - start.x;
+    const int64_t dy = int64_t{end.y} - start.y;
+
+    if (abs(dx) >= abs(dy))
+        trace_line(start.x, start.y, dx, dy, clip_.left, clip_.right, [this](int64_t x, int64_t y) { plot(x, y); });
+    else
+        trace_line(start.y, start.x, dy, dx, clip_.top, clip_.bottom, [this](int64_t y, int64_t x) { plot(x, y); });
+}
+
+void Rasterizer::polygon(const CommandBuffer::Points& points)
+{
+    const BoundingBox box = intersection(pixel_box(points), clip_);
+    if (box.empty())
+        return;
+
+    const size_t count = points.size();
+
+    for (int y = box.top; y <= box.bottom; ++y)
+    {
+        // crossings of edges with the horizontal line through centers of pixels
+        const double scan_y = y + 0.5;
+        crossings_.clear();
+
+        for (size_t i = 0, j = count - 1; i < count; j = i++)
+        {
+            const Point a = points[i];
+            const Point b = points[j];
+
+            if ((a.y <= scan_y) != (b.y <= scan_y))
+                crossings_.push_back(a.x + (scan_y - a.y) * (b.x - a.x) / (b.y - a.y));
+        }
+
+        sort(crossings_.begin(), crossings_.end());
+
+        // pixel x is inside when its center x + 0.5 lies in [from, to)
+        for (size_t i = 0; i + 1 < crossings_.size(); i += 2)
+        {
+            const double from = max(ceil(crossings_[i] - 0.5), static_cast<double>(box.left));
+            const double to = min(ceil(crossings_[i + 1] - 0.5) - 1, static_cast<double>(box.right));
+
+            if (from <= to)
+                span(y, static_cast<int>(from), static_cast<int>(to), palette_.polygon);
+        }
+    }
+}
+
+void rasterize(const CommandBuffer& commands, Framebuffer& framebuffer, const Palette& palette,
+               size_t no_of_threads, int tile_size)
+{
+    if (framebuffer.width() == 0 || framebuffer.height() == 0)
+        return;
+
+    tile_size = max(tile_size, 1);
+    const int columns = (framebuffer.width() + tile_size - 1) / tile_size;
+    const int rows = (framebuffer.height() + tile_size - 1) / tile_size;
+
+    vector<CommandBuffer> tiles(static_cast<size_t>(columns) * rows);
+    commands.replay(TileBinner{framebuffer.bounds(), tile_size, columns, tiles});
+
+    // tiles are taken one by one - the cost of tiles differs a lot
+    atomic<size_t> next_tile{0};
+    auto rasterize_tiles = [&]() {
+        for (size_t index = next_tile++; index < tiles.size(); index = next_tile++)
+        {
+            if (tiles[index].empty())
+                continue;
+
+            const int left = static_cast<int>(index % columns) * tile_size;
+            const int top = static_cast<int>(index / columns) * tile_size;
+            Rasterizer rasterizer{framebuffer, BoundingBox{left, top, left + tile_size - 1, top + tile_size - 1}, palette};
+            tiles[index].replay(rasterizer);
+        }
+    };
+
+    no_of_threads = max<size_t>(1, min(no_of_threads, tiles.size()));
+
+    vector<thread> threads;
+    for (size_t i = 1; i < no_of_threads; ++i)
+        threads.emplace_back(rasterize_tiles);
+
+    rasterize_tiles();
+
+    for (auto& thd : threads)
+        thd.join();
+}
@@ -0,0 +1,151 @@
+#ifndef RASTER_HPP
+#define RASTER_HPP
+
+#include "point.hpp"
+#include "render.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+// RGBA pixel - bytes in memory: r, g, b, a
+struct Color
+{
+    uint8_t r, g, b, a;
+
+    bool operator==(const Color& other) const
+    {
+        return r == other.r && g == other.g && b == other.b && a == other.a;
+    }
+
+    bool operator!=(const Color& other) const
+    {
+        return !(*this == other);
+    }
+};
+
+// colors of shapes - draw commands do not carry colors
+struct Palette
+{
+    Color circle{255, 0, 0, 255};
+    Color rectangle{0, 255, 0, 255};
+    Color line{255, 255, 255, 255};
+    Color polygon{0, 0, 255, 255};
+};
+
+// width x height RGBA pixels stored row by row; (0, 0) is the top-left pixel
+class Framebuffer
+{
+public:
+    Framebuffer(int width, int height, Color background = Color{0, 0, 0, 255});
+
+    int width() const
+    {
+        return width_;
+    }
+
+    int height() const
+    {
+        return height_;
+    }
+
+    BoundingBox bounds() const
+    {
+        return BoundingBox{0, 0, width_ - 1, height_ - 1};
+    }
+
+    Color& operator()(int x, int y)
+    {
+        return pixels_[static_cast<size_t>(y) * width_ + x];
+    }
+
+    const Color& operator()(int x, int y) const
+    {
+        return pixels_[static_cast<size_t>(y) * width_ + x];
+    }
+
+    Color* row(int y)
+    {
+        return pixels_.data() + static_cast<size_t>(y) * width_;
+    }
+
+    const std::vector<Color>& pixels() const
+    {
+        return pixels_;
+    }
+
+    void clear(Color color);
+
+    // raw RGBA bytes without any header (width * height * 4 bytes)
+    void write_raw(std::ostream& out) const;
+
+private:
+    int width_;
+    int height_;
+    std::vector<Color> pixels_;
+};
+
+// Draws commands into the framebuffer - every primitive is clipped to the clip box,
+// so rasterizers with disjoint clip boxes may run in parallel on the same framebuffer.
+// Circles, rectangles & polygons are filled; colors are overwritten (no blending).
+class Rasterizer
+{
+public:
+    Rasterizer(Framebuffer& framebuffer, const BoundingBox& clip, const Palette& palette = Palette{});
+
+    // midpoint circle - filled with horizontal spans
+    void circle(const Point& center, int radius);
+
+    // pixels [x, x + width) x [y, y + height)
+    void rectangle(const Point& corner, uint32_t width, uint32_t height);
+
+    // Bresenham - both end points are drawn; any int coordinates of end points
+    // (only the part of the line inside the clip box is traced)
+    void line(const Point& start, const Point& end);
+
+    // scanline fill (even-odd rule) - pixels with centers inside the polygon
+    void polygon(const CommandBuffer::Points& points);
+
+private:
+    void plot(int64_t x, int64_t y)
+    {
+        if (clip_.left <= x && x <= clip_.right && clip_.top <= y && y <= clip_.bottom)
+            framebuffer_(static_cast<int>(x), static_cast<int>(y)) = palette_.line;
+    }
+
+    template <typename TPlot>
+    void trace_line(int64_t major, int64_t minor, int64_t d_major, int64_t d_minor,
+                    int clip_first, int clip_last, TPlot plot);
+
+    void span(int y, int x_first, int x_last, Color color);
+
+    Framebuffer& framebuffer_;
+    BoundingBox clip_;
+    Palette palette_;
+    std::vector<double> crossings_;
+};
+
+// Framebuffer is split into square tiles - commands are binned to tiles they overlap
+// and tiles are rasterized by threads in parallel. Order of commands is kept within
+// every tile, so the result does not depend on the number of threads.
+void rasterize(const CommandBuffer& commands, Framebuffer& framebuffer, const Palette& palette = Palette{},
+               size_t no_of_threads = 1, int tile_size = 64);
+
+// batches submitted by Renderer are rasterized into the framebuffer
+class RasterSink : public RenderSink
+{
+    Framebuffer& framebuffer_;
+    Palette palette_;
+    size_t no_of_threads_;
+public:
+    explicit RasterSink(Framebuffer& framebuffer, const Palette& palette = Palette{}, size_t no_of_threads = 1)
+        : framebuffer_{framebuffer}, palette_{palette}, no_of_threads_{no_of_threads}
+    {}
+
+    void submit(const CommandBuffer& commands) override
+    {
+        rasterize(commands, framebuffer_, palette_, no_of_threads_);
+    }
+};
+
+#endif // RASTER_HPP
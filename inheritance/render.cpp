@@ -0,0 +1,193 @@
+#include "render.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <system_error>
+
+using namespace std;
+
+namespace
+{
+    constexpr size_t max_number_size = 11; // -2147483648
+    constexpr size_t max_point_size = 2 * max_number_size + 4;
+
+    // commands are formatted directly into the text - space for the longest text of a command
+    // is reserved up front, so writes are not checked
+    class TextFormatter
+    {
+        string& text_;
+        char* pos_ = nullptr;
+    public:
+        explicit TextFormatter(string& text) : text_{text}
+        {}
+
+        void circle(const Point& center, int radius)
+        {
+            begin(64);
+            append("Circle at ");
+            append(center);
+            append(" with r: ");
+            append(radius);
+            append('\n');
+            end();
+        }
+
+        void rectangle(const Point& corner, uint32_t width, uint32_t height)
+        {
+            begin(80);
+            append("Rectangle at ");
+            append(corner);
+            append(" w: ");
+            append(width);
+            append(", h: ");
+            append(height);
+            append('\n');
+            end();
+        }
+
+        void line(const Point& start, const Point& end_point)
+        {
+            begin(80);
+            append("Line from ");
+            append(start);
+            append(" to ");
+            append(end_point);
+            append('\n');
+            end();
+        }
+
+        void polygon(const CommandBuffer::Points& points)
+        {
+            begin(16 + points.size() * (max_point_size + 1));
+            append("Polygon: ");
+            for (size_t i = 0; i < points.size(); ++i)
+            {
+                append(points[i]);
+                append(' ');
+            }
+            append('\n');
+            end();
+        }
+
+    private:
+        void begin(size_t max_size)
+        {
+            const size_t size = text_.size();
+            text_.resize(size + max_size);
+            pos_ = &text_[size];
+        }
+
+        void end()
+        {
+            text_.resize(static_cast<size_t>(pos_ - text_.data()));
+        }
+
+        template <size_t N>
+        void append(const char (&literal)[N])
+        {
+            pos_ = copy_n(literal, N - 1, pos_);
+        }
+
+        void append(char c)
+        {
+            *pos_++ = c;
+        }
+
+        template <typename TNumber>
+        void append(TNumber value)
+        {
+            pos_ = to_chars(pos_, pos_ + max_number_size, value).ptr;
+        }
+
+        void append(const Point& pt)
+        {
+            append('(');
+            append(pt.x);
+            append(", ");
+            append(pt.y);
+            append(')');
+        }
+    };
+}
+
+void CommandBuffer::polygon(const Point* points, size_t count)
+{
+    words_.push_back(static_cast<int32_t>(Command::polygon));
+    words_.push_back(static_cast<int32_t>(count));
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        words_.push_back(points[i].x);
+        words_.push_back(points[i].y);
+    }
+}
+
+void CommandBuffer::polygon(const Points& points)
+{
+    words_.push_back(static_cast<int32_t>(Command::polygon));
+    words_.push_back(static_cast<int32_t>(points.size()));
+    words_.insert(words_.end(), points.coords(), points.coords() + 2 * points.size());
+}
+
+void format(const CommandBuffer& commands, string& text)
+{
+    commands.replay(TextFormatter{text});
+}
+
+void TextSink::submit(const CommandBuffer& commands)
+{
+    text_.clear();
+    format(commands, text_);
+
+    out_.write(text_.data(), static_cast<streamsize>(text_.size()));
+}
+
+FileSink::FileSink(const string& path)
+    : file_{fopen(path.c_str(), "wb")}
+{
+    if (!file_)
+        throw system_error(errno, generic_category(), "fopen: " + path);
+}
+
+FileSink::~FileSink()
+{
+    fclose(file_);
+}
+
+void FileSink::submit(const CommandBuffer& commands)
+{
+    text_.clear();
+    format(commands, text_);
+
+    if (fwrite(text_.data(), 1, text_.size(), file_) != text_.size())
+        throw system_error(errno, generic_category(), "fwrite");
+}
+
+Renderer::~Renderer()
+{
+    try
+    {
+        flush();
+    }
+    catch (...)
+    {
+        // Logging exception
+    }
+}
+
+void Renderer::flush()
+{
+    if (commands_.empty())
+        return;
+
+    sink_.submit(commands_);
+    commands_.clear();
+}
+
+void Renderer::submit(const CommandBuffer& commands)
+{
+    flush();
+
+    if (!commands.empty())
+        sink_.submit(commands);
+}
@@ -0,0 +1,262 @@
+#ifndef RENDER_HPP
+#define RENDER_HPP
+
+#include "point.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <initializer_list>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Compact draw commands stored in a flat array of 32-bit words:
+//   circle:    [circle, x, y, r]
+//   rectangle: [rectangle, x, y, w, h]
+//   line:      [line, x1, y1, x2, y2]
+//   polygon:   [polygon, n, x1, y1, ..., xn, yn]
+class CommandBuffer
+{
+public:
+    enum class Command : int32_t
+    {
+        circle, rectangle, line, polygon
+    };
+
+    // points of polygon command
+    class Points
+    {
+        const int32_t* coords_;
+        size_t size_;
+    public:
+        Points(const int32_t* coords, size_t size) : coords_{coords}, size_{size}
+        {}
+
+        size_t size() const
+        {
+            return size_;
+        }
+
+        Point operator[](size_t index) const
+        {
+            return Point{coords_[2 * index], coords_[2 * index + 1]};
+        }
+
+        // x1, y1, ..., xn, yn
+        const int32_t* coords() const
+        {
+            return coords_;
+        }
+    };
+
+    void reserve(size_t words)
+    {
+        words_.reserve(words);
+    }
+
+    // number of words
+    size_t size() const
+    {
+        return words_.size();
+    }
+
+    size_t capacity() const
+    {
+        return words_.capacity();
+    }
+
+    bool empty() const
+    {
+        return words_.empty();
+    }
+
+    void clear()
+    {
+        words_.clear();
+    }
+
+    void circle(const Point& center, int radius)
+    {
+        push(Command::circle, {center.x, center.y, radius});
+    }
+
+    void rectangle(const Point& corner, uint32_t width, uint32_t height)
+    {
+        push(Command::rectangle, {corner.x, corner.y, static_cast<int32_t>(width), static_cast<int32_t>(height)});
+    }
+
+    void line(const Point& start, const Point& end)
+    {
+        push(Command::line, {start.x, start.y, end.x, end.y});
+    }
+
+    void polygon(const Point* points, size_t count);
+    void polygon(const Points& points);
+
+    void append(const CommandBuffer& other)
+    {
+        words_.insert(words_.end(), other.words_.begin(), other.words_.end());
+    }
+
+    // commands are passed to visitor in the order of appending:
+    // circle(center, r), rectangle(corner, w, h), line(start, end), polygon(Points)
+    template <typename TVisitor>
+    void replay(TVisitor&& visitor) const
+    {
+        const int32_t* cmd = words_.data();
+        const int32_t* const end = cmd + words_.size();
+
+        while (cmd != end)
+        {
+            switch (static_cast<Command>(cmd[0]))
+            {
+                case Command::circle:
+                    visitor.circle(Point{cmd[1], cmd[2]}, cmd[3]);
+                    cmd += 4;
+                    break;
+                case Command::rectangle:
+                    visitor.rectangle(Point{cmd[1], cmd[2]}, static_cast<uint32_t>(cmd[3]), static_cast<uint32_t>(cmd[4]));
+                    cmd += 5;
+                    break;
+                case Command::line:
+                    visitor.line(Point{cmd[1], cmd[2]}, Point{cmd[3], cmd[4]});
+                    cmd += 5;
+                    break;
+                case Command::polygon:
+                    visitor.polygon(Points{cmd + 2, static_cast<size_t>(cmd[1])});
+                    cmd += 2 + 2 * static_cast<size_t>(cmd[1]);
+                    break;
+            }
+        }
+    }
+
+private:
+    void push(Command command, std::initializer_list<int32_t> args)
+    {
+        words_.push_back(static_cast<int32_t>(command));
+        words_.insert(words_.end(), args.begin(), args.end());
+    }
+
+    std::vector<int32_t> words_;
+};
+
+// the same text as draw() of shapes - appended to text
+void format(const CommandBuffer& commands, std::string& text);
+
+// Receives batches of commands flushed by Renderer
+class RenderSink
+{
+public:
+    virtual ~RenderSink() = default;
+    virtual void submit(const CommandBuffer& commands) = 0;
+};
+
+// text written to the stream - one write per batch
+class TextSink : public RenderSink
+{
+    std::ostream& out_;
+    std::string text_;
+public:
+    explicit TextSink(std::ostream& out) : out_{out}
+    {}
+
+    void submit(const CommandBuffer& commands) override;
+};
+
+// text written to the file - one fwrite per batch
+class FileSink : public RenderSink
+{
+    std::FILE* file_;
+    std::string text_;
+public:
+    explicit FileSink(const std::string& path);
+
+    FileSink(const FileSink&) = delete;
+    FileSink& operator=(const FileSink&) = delete;
+
+    ~FileSink() override;
+
+    void submit(const CommandBuffer& commands) override;
+};
+
+// commands kept in memory
+class MemorySink : public RenderSink
+{
+    CommandBuffer commands_;
+public:
+    void submit(const CommandBuffer& commands) override
+    {
+        commands_.append(commands);
+    }
+
+    const CommandBuffer& commands() const
+    {
+        return commands_;
+    }
+
+    std::string text() const
+    {
+        std::string text;
+        format(commands_, text);
+        return text;
+    }
+};
+
+// Draw commands are collected in a preallocated buffer - the buffer is submitted to the sink
+// when it is full, on flush() and in the destructor
+class Renderer
+{
+public:
+    explicit Renderer(RenderSink& sink, size_t buffer_size = 64 * 1024 /* words */)
+        : sink_{sink}, buffer_size_{buffer_size}
+    {
+        commands_.reserve(buffer_size);
+    }
+
+    Renderer(const Renderer&) = delete;
+    Renderer& operator=(const Renderer&) = delete;
+
+    ~Renderer();
+
+    void circle(const Point& center, int radius)
+    {
+        make_room(4);
+        commands_.circle(center, radius);
+    }
+
+    void rectangle(const Point& corner, uint32_t width, uint32_t height)
+    {
+        make_room(5);
+        commands_.rectangle(corner, width, height);
+    }
+
+    void line(const Point& start, const Point& end)
+    {
+        make_room(5);
+        commands_.line(start, end);
+    }
+
+    void polygon(const Point* points, size_t count)
+    {
+        make_room(2 + 2 * count);
+        commands_.polygon(points, count);
+    }
+
+    void flush();
+
+    // pending commands are flushed first - commands are passed to the sink without copying
+    void submit(const CommandBuffer& commands);
+
+private:
+    void make_room(size_t words)
+    {
+        if (commands_.size() + words > buffer_size_ && !commands_.empty())
+            flush();
+    }
+
+    RenderSink& sink_;
+    size_t buffer_size_;
+    CommandBuffer commands_;
+};
+
+#endif // RENDER_HPP
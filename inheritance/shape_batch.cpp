@@ -0,0 +1,159 @@
+#include "shape_batch.hpp"
+
+using namespace std;
+
+namespace
+{
+    constexpr size_t min_chunk_size = 64 * 1024; // points per task
+
+    void translate(int* values, size_t count, int delta)
+    {
+        for (size_t i = 0; i < count; ++i) // vectorized by the compiler (SSE2, AVX2 with -mavx2)
+            values[i] += delta;
+    }
+
+    template <typename TShape>
+    void move_to(TShape& shape, const Point& pt)
+    {
+        shape.move(pt.x - shape.coord().x, pt.y - shape.coord().y);
+    }
+}
+
+size_t ShapeBatch::add_point(const Point& pt)
+{
+    xs_.push_back(pt.x);
+    ys_.push_back(pt.y);
+
+    return xs_.size() - 1;
+}
+
+void ShapeBatch::add(const Circle& circle)
+{
+    refs_.push_back(ShapeRef{ShapeKind::circle, circles_.size()});
+    circles_.push_back(CircleData{add_point(circle.coord()), circle.radius()});
+}
+
+void ShapeBatch::add(const Rectangle& rectangle)
+{
+    refs_.push_back(ShapeRef{ShapeKind::rectangle, rectangles_.size()});
+    rectangles_.push_back(RectangleData{add_point(rectangle.coord()), rectangle.width(), rectangle.height()});
+}
+
+void ShapeBatch::add(const Line& line)
+{
+    refs_.push_back(ShapeRef{ShapeKind::line, lines_.size()});
+    lines_.push_back(add_point(line.coord()));
+    add_point(line.end());
+}
+
+void ShapeBatch::add(const Polygon& polygon)
+{
+    refs_.push_back(ShapeRef{ShapeKind::polygon, polygons_.size()});
+    polygons_.push_back(PolygonData{xs_.size(), polygon.points().size()});
+
+    for (const auto& pt : polygon.points())
+        add_point(pt);
+}
+
+void ShapeBatch::translate(int dx, int dy)
+{
+    ::translate(xs_.data(), xs_.size(), dx);
+    ::translate(ys_.data(), ys_.size(), dy);
+}
+
+void ShapeBatch::translate(int dx, int dy, ThreadPool& pool)
+{
+    parallel_for(xs_.size(), [this, dx, dy](size_t first, size_t last) {
+        ::translate(xs_.data() + first, last - first, dx);
+        ::translate(ys_.data() + first, last - first, dy);
+    }, pool, min_chunk_size);
+}
+
+void ShapeBatch::write_back(ShapeStore& store) const
+{
+    auto& circles = store.get<Circle>();
+    for (size_t i = 0; i < circles_.size(); ++i)
+        move_to(circles[i], point(circles_[i].point));
+
+    auto& rectangles = store.get<Rectangle>();
+    for (size_t i = 0; i < rectangles_.size(); ++i)
+        move_to(rectangles[i], point(rectangles_[i].point));
+
+    auto& lines = store.get<Line>();
+    for (size_t i = 0; i < lines_.size(); ++i)
+        move_to(lines[i], point(lines_[i])); // end is translated by the same offset
+
+    auto& polygons = store.get<Polygon>();
+    for (size_t i = 0; i < polygons_.size(); ++i)
+    {
+        if (polygons_[i].no_of_points == 0)
+            continue;
+
+        const Point& first = polygons[i].points()[0];
+        const Point pt = point(polygons_[i].first_point);
+        polygons[i].move(pt.x - first.x, pt.y - first.y);
+    }
+}
+
+Circle ShapeBatch::circle(size_t index) const
+{
+    return Circle{point(circles_[index].point), circles_[index].radius};
+}
+
+Rectangle ShapeBatch::rectangle(size_t index) const
+{
+    const RectangleData& data = rectangles_[index];
+    return Rectangle{point(data.point), data.width, data.height};
+}
+
+Line ShapeBatch::line(size_t index) const
+{
+    return Line{point(lines_[index]), point(lines_[index] + 1)};
+}
+
+Polygon ShapeBatch::polygon(size_t index) const
+{
+    const PolygonData& data = polygons_[index];
+
+    vector<Point> points;
+    points.reserve(data.no_of_points);
+    for (size_t i = 0; i < data.no_of_points; ++i)
+        points.push_back(point(data.first_point + i));
+
+    return Polygon{points};
+}
+
+void ShapeBatch::render(Renderer& renderer) const
+{
+    vector<Point> points; // polygon points are gathered from xs & ys
+
+    for (const ShapeRef& ref : refs_)
+    {
+        switch (ref.kind)
+        {
+            case ShapeKind::circle:
+                renderer.circle(point(circles_[ref.index].point), circles_[ref.index].radius);
+                break;
+            case ShapeKind::rectangle:
+            {
+                const RectangleData& data = rectangles_[ref.index];
+                renderer.rectangle(point(data.point), data.width, data.height);
+                break;
+            }
+            case ShapeKind::line:
+                renderer.line(point(lines_[ref.index]), point(lines_[ref.index] + 1));
+                break;
+            case ShapeKind::polygon:
+            {
+                const PolygonData& data = polygons_[ref.index];
+                points.clear();
+                for (size_t i = 0; i < data.no_of_points; ++i)
+                    points.push_back(point(data.first_point + i));
+                renderer.polygon(points.data(), points.size());
+                break;
+            }
+            case ShapeKind::other: // shapes of other types are not added to batches
+                break;
+        }
+    }
+}
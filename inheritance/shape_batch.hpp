@@ -0,0 +1,102 @@
+#ifndef SHAPE_BATCH_HPP
+#define SHAPE_BATCH_HPP
+
+#include "render.hpp"
+#include "shape_store.hpp"
+#include "shapes.hpp"
+#include "thread_pool.hpp"
+#include <cstddef>
+#include <vector>
+
+// Shapes with coordinates of all points kept in two arrays (struct-of-arrays: xs, ys) -
+// translation of the whole batch is a single pass vectorized by the compiler that can be split
+// among threads of the pool. Shapes are rendered in the order of add() (see Drawing::batch());
+// coordinates are written back to the shapes with write_back().
+class ShapeBatch
+{
+public:
+    void add(const Circle& circle);
+    void add(const Rectangle& rectangle);
+    void add(const Line& line);
+    void add(const Polygon& polygon);
+
+    // the same result as move(dx, dy) called for every shape
+    void translate(int dx, int dy);
+
+    // chunks of points are translated by threads of the pool
+    void translate(int dx, int dy, ThreadPool& pool);
+
+    // shapes of the store are moved to the coordinates of the batch - the batch must be built
+    // from all shapes of the store (k-th shape of every type in the batch is the k-th shape
+    // of that type in the store) and changed only by translate()
+    void write_back(ShapeStore& store) const;
+
+    size_t no_of_points() const
+    {
+        return xs_.size();
+    }
+
+    size_t no_of_circles() const
+    {
+        return circles_.size();
+    }
+
+    size_t no_of_rectangles() const
+    {
+        return rectangles_.size();
+    }
+
+    size_t no_of_lines() const
+    {
+        return lines_.size();
+    }
+
+    size_t no_of_polygons() const
+    {
+        return polygons_.size();
+    }
+
+    // compatibility with IShape API - copies of shapes
+    Circle circle(size_t index) const;
+    Rectangle rectangle(size_t index) const;
+    Line line(size_t index) const;
+    Polygon polygon(size_t index) const;
+
+    // the same commands as draw(renderer) of shapes - in the order of add()
+    void render(Renderer& renderer) const;
+
+private:
+    struct CircleData
+    {
+        size_t point;
+        int radius;
+    };
+
+    struct RectangleData
+    {
+        size_t point;
+        uint32_t width, height;
+    };
+
+    struct PolygonData
+    {
+        size_t first_point, no_of_points;
+    };
+
+    size_t add_point(const Point& pt);
+
+    Point point(size_t index) const
+    {
+        return Point{xs_[index], ys_[index]};
+    }
+
+    std::vector<ShapeRef> refs_; // in the order of add()
+    std::vector<int> xs_;
+    std::vector<int> ys_;
+    std::vector<CircleData> circles_;
+    std::vector<RectangleData> rectangles_;
+    std::vector<size_t> lines_; // start & end - consecutive points
+    std::vector<PolygonData> polygons_;
+};
+
+#endif // SHAPE_BATCH_HPP
@@ -0,0 +1,169 @@
+#ifndef SHAPE_STORE_HPP
+#define SHAPE_STORE_HPP
+
+#include "parallel_shapes.hpp"
+#include "shapes.hpp"
+#include "stable_vector.hpp"
+#include "thread_pool.hpp"
+#include <cstddef>
+#include <tuple>
+#include <utility>
+
+enum class ShapeKind
+{
+    circle, rectangle, line, polygon,
+    other // shape of other type owned by the user of the store (e.g. Drawing::add())
+};
+
+// position of the shape in ShapeStore
+struct ShapeRef
+{
+    ShapeKind kind;
+    size_t index;
+};
+
+template <typename TShape>
+struct ShapeKindOf;
+
+template <>
+struct ShapeKindOf<Circle> { static constexpr ShapeKind value = ShapeKind::circle; };
+
+template <>
+struct ShapeKindOf<Rectangle> { static constexpr ShapeKind value = ShapeKind::rectangle; };
+
+template <>
+struct ShapeKindOf<Line> { static constexpr ShapeKind value = ShapeKind::line; };
+
+template <>
+struct ShapeKindOf<Polygon> { static constexpr ShapeKind value = ShapeKind::polygon; };
+
+// Type-segregated storage of shapes - every type of shape is kept in its own
+// array of contiguous chunks (shapes are constructed in place & never relocated).
+// Bulk moves iterate arrays linearly & call methods of final classes
+// (no virtual dispatch). Shapes are visited type by type:
+// circles, rectangles, lines, polygons - order of drawing is kept by the owner
+// (see Drawing) and shapes are drawn through visit().
+class ShapeStore
+{
+public:
+    template <typename TShape, typename... TArgs>
+    TShape& emplace(TArgs&&... args)
+    {
+        return get<TShape>().emplace_back(std::forward<TArgs>(args)...);
+    }
+
+    template <typename TShape>
+    void reserve(size_t capacity)
+    {
+        get<TShape>().reserve(capacity);
+    }
+
+    template <typename TShape>
+    StableVector<TShape>& get()
+    {
+        return std::get<StableVector<TShape>>(shapes_);
+    }
+
+    template <typename TShape>
+    const StableVector<TShape>& get() const
+    {
+        return std::get<StableVector<TShape>>(shapes_);
+    }
+
+    size_t size() const
+    {
+        return get<Circle>().size() + get<Rectangle>().size() + get<Line>().size() + get<Polygon>().size();
+    }
+
+    // f(shapes) is called for the array of every type
+    template <typename TFunction>
+    void for_each_array(TFunction f)
+    {
+        f(get<Circle>());
+        f(get<Rectangle>());
+        f(get<Line>());
+        f(get<Polygon>());
+    }
+
+    template <typename TFunction>
+    void for_each_array(TFunction f) const
+    {
+        f(get<Circle>());
+        f(get<Rectangle>());
+        f(get<Line>());
+        f(get<Polygon>());
+    }
+
+    // f(shape) is called for the shape of concrete type - ref must not be ShapeKind::other
+    template <typename TFunction>
+    decltype(auto) visit(ShapeRef ref, TFunction f)
+    {
+        switch (ref.kind)
+        {
+            case ShapeKind::circle:
+                return f(get<Circle>()[ref.index]);
+            case ShapeKind::rectangle:
+                return f(get<Rectangle>()[ref.index]);
+            case ShapeKind::line:
+                return f(get<Line>()[ref.index]);
+            default:
+                return f(get<Polygon>()[ref.index]);
+        }
+    }
+
+    template <typename TFunction>
+    decltype(auto) visit(ShapeRef ref, TFunction f) const
+    {
+        switch (ref.kind)
+        {
+            case ShapeKind::circle:
+                return f(get<Circle>()[ref.index]);
+            case ShapeKind::rectangle:
+                return f(get<Rectangle>()[ref.index]);
+            case ShapeKind::line:
+                return f(get<Line>()[ref.index]);
+            default:
+                return f(get<Polygon>()[ref.index]);
+        }
+    }
+
+    // compatibility with IShape API - f(IShape&)
+    template <typename TFunction>
+    void for_each(TFunction f)
+    {
+        for_each_array([&f](auto& shapes) {
+            for (auto& shape : shapes)
+                f(static_cast<IShape&>(shape));
+        });
+    }
+
+    template <typename TFunction>
+    void for_each(TFunction f) const
+    {
+        for_each_array([&f](const auto& shapes) {
+            for (const auto& shape : shapes)
+                f(static_cast<const IShape&>(shape));
+        });
+    }
+
+    void move_all(int dx, int dy)
+    {
+        for_each_array([dx, dy](auto& shapes) {
+            for (auto& shape : shapes)
+                shape.move(dx, dy); // final class - resolved statically
+        });
+    }
+
+    // arrays are split into chunks moved by threads of the pool
+    void move_all(int dx, int dy, ThreadPool& pool)
+    {
+        for_each_array([dx, dy, &pool](auto& shapes) {
+            parallel_for_each(shapes, [dx, dy](auto& shape) { shape.move(dx, dy); }, pool);
+        });
+    }
+
+private:
+    std::tuple<StableVector<Circle>, StableVector<Rectangle>, StableVector<Line>, StableVector<Polygon>> shapes_;
+};
+
+#endif // SHAPE_STORE_HPP
@@ -0,0 +1,254 @@
+#ifndef SHAPES_HPP
+#define SHAPES_HPP
+
+#include "point.hpp"
+#include "render.hpp"
+#include "small_vector.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <initializer_list>
+#include <memory_resource>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+class IShape
+{
+public:
+    virtual ~IShape() = default;
+    virtual void move(int dx, int dy) = 0;
+    virtual void draw() const = 0;
+
+    // appends draw commands to the renderer - output goes only to the sink of the renderer
+    virtual void draw(Renderer& renderer) const = 0;
+};
+
+class Shape : public IShape
+{
+    Point coord_;
+public:
+    Shape(const Point& coord) : coord_{coord}
+    {}
+
+    Shape(int x = 0, int y = 0) : coord_{x, y}
+    {}
+
+    ~Shape() noexcept override
+    {
+        std::cout << "~Shape(" << coord_ << ")\n";
+    }
+
+    void move(int dx, int dy) override
+    {
+        coord_.x += dx;
+        coord_.y += dy;
+    }
+
+    const Point& coord() const
+    {
+        return coord_;
+    }
+};
+
+
+class Circle final : public Shape
+{
+    int radius_;
+public:
+    Circle(int x = 0, int y = 0, int r = 0)
+        : Shape{x, y}, radius_{r}
+    {}
+
+    Circle(const Point& pt, int r) : Shape{pt}, radius_{r}
+    {}
+
+    ~Circle() noexcept override
+    {
+        std::cout << "~Circle(" << coord() << ")\n";
+    }
+
+    int radius() const
+    {
+        return radius_;
+    }
+
+    void draw() const override
+    {
+        std::cout << "Circle at " << coord() << " with r: " << radius_ << "\n";
+    }
+
+    void draw(Renderer& renderer) const override
+    {
+        renderer.circle(coord(), radius_);
+    }
+};
+
+
+class Rectangle final : public Shape
+{
+    uint32_t width_;
+    uint32_t height_;
+public:
+    Rectangle(int x, int y, uint32_t w, uint32_t h)
+        : Shape{x, y}, width_{w}, height_{h}
+    {}
+
+    Rectangle(const Point& pt, uint32_t w, uint32_t h)
+        : Shape{pt}, width_{w}, height_{h}
+    {}
+
+    ~Rectangle() noexcept override
+    {
+        std::cout << "~Rectangle(" << coord()<< ")\n";
+    }
+
+    uint32_t width() const
+    {
+        return width_;
+    }
+
+    uint32_t height() const
+    {
+        return height_;
+    }
+
+    void draw() const override
+    {
+        std::cout << "Rectangle at " << coord()
+                  << " w: " << width_<< ", h: " << height_ << "\n";
+    }
+
+    void draw(Renderer& renderer) const override
+    {
+        renderer.rectangle(coord(), width_, height_);
+    }
+};
+
+class Line final : public Shape
+{
+    Point end_;
+public:
+    Line(int x_start = 0, int y_start = 0, int x_end = 0, int y_end = 0)
+        : Shape{x_start, y_start}, end_{x_end, y_end}
+    {}
+
+    Line(const Point& start, const Point& end) : Shape{start}, end_{end}
+    {}
+
+    ~Line() override
+    {
+        std::cout << "~Line(" << coord() << ")\n";
+    }
+
+    const Point& end() const
+    {
+        return end_;
+    }
+
+    void move(int dx, int dy) override
+    {
+        Shape::move(dx, dy); // call of method from base class
+
+        end_.x += dx;
+        end_.y += dy;
+    }
+
+    void draw() const override
+    {
+        std::cout << "Line from " << coord() << " to " << end_ << "\n";
+    }
+
+    void draw(Renderer& renderer) const override
+    {
+        renderer.line(coord(), end_);
+    }
+};
+
+class Polygon final : public IShape
+{
+public:
+    // triangles & quadrilaterals are stored inline
+    static constexpr size_t inline_points = 4;
+    using Points = SmallVector<Point, inline_points>;
+
+    // points are allocated at most once - from the global heap or from the arena shared by many
+    // polygons (e.g. std::pmr::monotonic_buffer_resource); the arena must outlive the polygon
+    Polygon(std::initializer_list<Point> pts, std::pmr::memory_resource* arena = nullptr)
+        : points_(pts, arena)
+    {}
+
+    explicit Polygon(const std::vector<Point>& pts, std::pmr::memory_resource* arena = nullptr)
+        : points_(pts.begin(), pts.end(), arena)
+    {}
+
+    const Points& points() const
+    {
+        return points_;
+    }
+
+    void move(int dx, int dy) override
+    {
+        for(auto& pt : points_)
+        {
+            pt.x += dx;
+            pt.y += dy;
+        }
+    }
+
+    void draw() const override
+    {
+        std::cout << "Polygon: ";
+        for(const auto& pt : points_)
+            std::cout << pt << " ";
+        std::cout << "\n";
+    }
+
+    void draw(Renderer& renderer) const override
+    {
+        renderer.polygon(points_.data(), points_.size());
+    }
+
+private:
+    Points points_;
+};
+
+inline BoundingBox bounding_box(const Circle& circle)
+{
+    const Point& center = circle.coord();
+    return BoundingBox{center.x - circle.radius(), center.y - circle.radius(),
+                       center.x + circle.radius(), center.y + circle.radius()};
+}
+
+inline BoundingBox bounding_box(const Rectangle& rectangle)
+{
+    const Point& corner = rectangle.coord();
+    return BoundingBox{corner.x, corner.y,
+                       corner.x + static_cast<int>(rectangle.width()), corner.y + static_cast<int>(rectangle.height())};
+}
+
+inline BoundingBox bounding_box(const Line& line)
+{
+    const Point& start = line.coord();
+    const Point& end = line.end();
+    return BoundingBox{std::min(start.x, end.x), std::min(start.y, end.y),
+                       std::max(start.x, end.x), std::max(start.y, end.y)};
+}
+
+inline BoundingBox bounding_box(const Polygon& polygon)
+{
+    if (polygon.points().empty())
+        return BoundingBox{0, 0, -1, -1}; // empty - intersects nothing
+
+    BoundingBox box{polygon.points()[0].x, polygon.points()[0].y, polygon.points()[0].x, polygon.points()[0].y};
+    for (const auto& pt : polygon.points())
+    {
+        box.left = std::min(box.left, pt.x);
+        box.top = std::min(box.top, pt.y);
+        box.right = std::max(box.right, pt.x);
+        box.bottom = std::max(box.bottom, pt.y);
+    }
+
+    return box;
+}
+
+#endif // SHAPES_HPP
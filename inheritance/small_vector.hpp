@@ -0,0 +1,193 @@
+#ifndef SMALL_VECTOR_HPP
+#define SMALL_VECTOR_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+
+// Fixed-size array of trivially copyable items - up to N items are stored inline (no allocation),
+// larger arrays are allocated exactly once from the memory resource (nullptr - global operator new).
+// With a monotonic resource (arena) items of many arrays are packed one after another in the same
+// blocks of memory. The resource must outlive the array; it is moved (not copied) with the items.
+template <typename T, size_t N>
+class SmallVector
+{
+    static_assert(std::is_trivially_copyable_v<T>, "SmallVector supports only trivially copyable items");
+
+public:
+    using value_type = T;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    explicit SmallVector(std::pmr::memory_resource* resource = nullptr)
+        : size_{0}, resource_{resource}
+    {}
+
+    template <typename TIterator>
+    SmallVector(TIterator first, TIterator last,
+                std::pmr::memory_resource* resource = nullptr)
+        : size_{static_cast<size_t>(std::distance(first, last))}, resource_{resource}
+    {
+        allocate();
+        std::copy(first, last, data());
+    }
+
+    SmallVector(std::initializer_list<T> items, std::pmr::memory_resource* resource = nullptr)
+        : SmallVector(items.begin(), items.end(), resource)
+    {}
+
+    // copy is allocated from the global heap - like copies of std::pmr containers
+    SmallVector(const SmallVector& source)
+        : SmallVector(source.begin(), source.end())
+    {}
+
+    SmallVector& operator=(const SmallVector& source)
+    {
+        if (this != &source)
+        {
+            SmallVector temp(source.begin(), source.end(), resource_);
+            swap(temp);
+        }
+
+        return *this;
+    }
+
+    SmallVector(SmallVector&& source) noexcept
+        : size_{source.size_}, resource_{source.resource_}
+    {
+        steal(source);
+    }
+
+    SmallVector& operator=(SmallVector&& source) noexcept
+    {
+        if (this != &source)
+        {
+            deallocate();
+            size_ = source.size_;
+            resource_ = source.resource_;
+            steal(source);
+        }
+
+        return *this;
+    }
+
+    ~SmallVector()
+    {
+        deallocate();
+    }
+
+    void swap(SmallVector& other) noexcept
+    {
+        SmallVector temp(std::move(other));
+        other = std::move(*this);
+        *this = std::move(temp);
+    }
+
+    bool is_inline() const
+    {
+        return size_ <= N;
+    }
+
+    std::pmr::memory_resource* resource() const
+    {
+        return resource_;
+    }
+
+    size_t size() const
+    {
+        return size_;
+    }
+
+    bool empty() const
+    {
+        return size_ == 0;
+    }
+
+    T* data()
+    {
+        return is_inline() ? items_ : heap_;
+    }
+
+    const T* data() const
+    {
+        return is_inline() ? items_ : heap_;
+    }
+
+    T& operator[](size_t index)
+    {
+        return data()[index];
+    }
+
+    const T& operator[](size_t index) const
+    {
+        return data()[index];
+    }
+
+    iterator begin()
+    {
+        return data();
+    }
+
+    iterator end()
+    {
+        return data() + size_;
+    }
+
+    const_iterator begin() const
+    {
+        return data();
+    }
+
+    const_iterator end() const
+    {
+        return data() + size_;
+    }
+
+private:
+    void allocate()
+    {
+        if (is_inline())
+            return;
+
+        if (resource_)
+            heap_ = static_cast<T*>(resource_->allocate(size_ * sizeof(T), alignof(T)));
+        else
+            heap_ = static_cast<T*>(::operator new(size_ * sizeof(T)));
+    }
+
+    void deallocate() noexcept
+    {
+        if (is_inline())
+            return;
+
+        if (resource_)
+            resource_->deallocate(heap_, size_ * sizeof(T), alignof(T));
+        else
+            ::operator delete(heap_);
+    }
+
+    // source is left empty
+    void steal(SmallVector& source) noexcept
+    {
+        if (is_inline())
+            std::copy(source.items_, source.items_ + size_, items_);
+        else
+            heap_ = source.heap_;
+
+        source.size_ = 0;
+    }
+
+    union
+    {
+        T items_[N];
+        T* heap_;
+    };
+    size_t size_;
+    std::pmr::memory_resource* resource_;
+};
+
+#endif // SMALL_VECTOR_HPP
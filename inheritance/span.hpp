@@ -0,0 +1,64 @@
+#ifndef SPAN_HPP
+#define SPAN_HPP
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+// Non-owning view of contiguous items (like std::span from C++20) - passing a span
+// of shapes does not copy the array
+template <typename T>
+class Span
+{
+    T* data_;
+    size_t size_;
+public:
+    Span() : data_{nullptr}, size_{0}
+    {}
+
+    Span(T* data, size_t size) : data_{data}, size_{size}
+    {}
+
+    // any container with contiguous storage - e.g. std::vector
+    template <typename TContainer,
+              typename = std::enable_if_t<std::is_convertible_v<decltype(std::declval<TContainer&>().data()), T*>>>
+    Span(TContainer& container) : data_{container.data()}, size_{container.size()}
+    {}
+
+    T* data() const
+    {
+        return data_;
+    }
+
+    size_t size() const
+    {
+        return size_;
+    }
+
+    bool empty() const
+    {
+        return size_ == 0;
+    }
+
+    T& operator[](size_t index) const
+    {
+        return data_[index];
+    }
+
+    T* begin() const
+    {
+        return data_;
+    }
+
+    T* end() const
+    {
+        return data_ + size_;
+    }
+
+    Span subspan(size_t offset, size_t count) const
+    {
+        return Span{data_ + offset, count};
+    }
+};
+
+#endif // SPAN_HPP
@@ -0,0 +1,137 @@
+#include "spatial_grid.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+using namespace std;
+
+namespace
+{
+    void remove_id(vector<uint32_t>& ids, uint32_t id)
+    {
+        auto it = find(ids.begin(), ids.end(), id);
+        *it = ids.back();
+        ids.pop_back();
+    }
+}
+
+SpatialGrid::SpatialGrid(int cell_size)
+    : cell_size_{cell_size}
+{
+    if (cell_size <= 0)
+        throw invalid_argument("Cell size must be positive");
+}
+
+size_t SpatialGrid::insert(const BoundingBox& box)
+{
+    const uint32_t id = static_cast<uint32_t>(boxes_.size());
+
+    boxes_.push_back(to_grid(box));
+    ranges_.push_back(cells(boxes_.back()));
+    link(id, ranges_.back());
+
+    return id;
+}
+
+void SpatialGrid::update(size_t id, const BoundingBox& box)
+{
+    boxes_[id] = to_grid(box);
+
+    const CellRange range = cells(boxes_[id]);
+    if (range == ranges_[id])
+        return;
+
+    unlink(static_cast<uint32_t>(id), ranges_[id]);
+    ranges_[id] = range;
+    link(static_cast<uint32_t>(id), range);
+}
+
+void SpatialGrid::query(const BoundingBox& world_area, vector<size_t>& ids) const
+{
+    const BoundingBox area = to_grid(world_area);
+
+    for (uint32_t id : oversized_)
+        if (boxes_[id].intersects(area))
+            ids.push_back(id);
+
+    const CellRange range = cells(area);
+
+    auto report_cell = [&](int cell_x, int cell_y, const vector<uint32_t>& cell) {
+        for (uint32_t id : cell)
+            if (boxes_[id].intersects(area) && is_reported_by(cell_x, cell_y, boxes_[id], area))
+                ids.push_back(id);
+    };
+
+    if (range.no_of_cells() <= cells_.size())
+    {
+        for (int y = range.first_y; y <= range.last_y; ++y)
+            for (int x = range.first_x; x <= range.last_x; ++x)
+            {
+                auto it = cells_.find(key(x, y));
+                if (it != cells_.end())
+                    report_cell(x, y, it->second);
+            }
+    }
+    else // area larger than the occupied part of the grid
+    {
+        for (const auto& cell : cells_)
+        {
+            const int x = static_cast<int>(static_cast<uint32_t>(cell.first >> 32));
+            const int y = static_cast<int>(static_cast<uint32_t>(cell.first));
+
+            if (range.first_x <= x && x <= range.last_x && range.first_y <= y && y <= range.last_y)
+                report_cell(x, y, cell.second);
+        }
+    }
+}
+
+int SpatialGrid::cell_of(int coordinate) const
+{
+    return coordinate >= 0 ? coordinate / cell_size_ : -((-(coordinate + 1)) / cell_size_) - 1;
+}
+
+SpatialGrid::CellRange SpatialGrid::cells(const BoundingBox& box) const
+{
+    return CellRange{cell_of(box.left), cell_of(box.top), cell_of(box.right), cell_of(box.bottom)};
+}
+
+bool SpatialGrid::is_oversized(const CellRange& range) const
+{
+    return range.last_x < range.first_x || range.last_y < range.first_y // empty box
+        || range.no_of_cells() > max_cells_per_box;
+}
+
+void SpatialGrid::link(uint32_t id, const CellRange& range)
+{
+    if (is_oversized(range))
+    {
+        oversized_.push_back(id);
+        return;
+    }
+
+    for (int y = range.first_y; y <= range.last_y; ++y)
+        for (int x = range.first_x; x <= range.last_x; ++x)
+            cells_[key(x, y)].push_back(id);
+}
+
+void SpatialGrid::unlink(uint32_t id, const CellRange& range)
+{
+    if (is_oversized(range))
+    {
+        remove_id(oversized_, id);
+        return;
+    }
+
+    for (int y = range.first_y; y <= range.last_y; ++y)
+        for (int x = range.first_x; x <= range.last_x; ++x)
+        {
+            auto it = cells_.find(key(x, y));
+            remove_id(it->second, id);
+            if (it->second.empty())
+                cells_.erase(it);
+        }
+}
+
+bool SpatialGrid::is_reported_by(int cell_x, int cell_y, const BoundingBox& box, const BoundingBox& area) const
+{
+    return cell_of(max(box.left, area.left)) == cell_x && cell_of(max(box.top, area.top)) == cell_y;
+}
@@ -0,0 +1,102 @@
+#ifndef SPATIAL_GRID_HPP
+#define SPATIAL_GRID_HPP
+
+#include "shapes.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Uniform grid over bounding boxes - every box is linked to the cells it overlaps
+// (boxes spanning more than max_cells_per_box cells are kept on a separate list).
+// Queries visit only cells overlapping the area - O(1 + k) for evenly spread boxes.
+// Translation of all boxes is O(1) - grid keeps a common offset.
+class SpatialGrid
+{
+public:
+    static constexpr size_t max_cells_per_box = 64;
+
+    explicit SpatialGrid(int cell_size = 64);
+
+    // returns id of the box - ids are consecutive numbers starting from 0
+    size_t insert(const BoundingBox& box);
+
+    // relinks the box only when it moved to other cells
+    void update(size_t id, const BoundingBox& box);
+
+    void translate(int dx, int dy)
+    {
+        offset_x_ += dx;
+        offset_y_ += dy;
+    }
+
+    size_t size() const
+    {
+        return boxes_.size();
+    }
+
+    BoundingBox box(size_t id) const
+    {
+        return to_world(boxes_[id]);
+    }
+
+    // ids of boxes intersecting the area are appended to ids (in unspecified order)
+    void query(const BoundingBox& area, std::vector<size_t>& ids) const;
+
+    void hit_test(const Point& pt, std::vector<size_t>& ids) const
+    {
+        query(BoundingBox{pt.x, pt.y, pt.x, pt.y}, ids);
+    }
+
+private:
+    struct CellRange
+    {
+        int first_x, first_y, last_x, last_y;
+
+        bool operator==(const CellRange& other) const
+        {
+            return first_x == other.first_x && first_y == other.first_y
+                && last_x == other.last_x && last_y == other.last_y;
+        }
+
+        size_t no_of_cells() const
+        {
+            return static_cast<size_t>(last_x - first_x + 1) * static_cast<size_t>(last_y - first_y + 1);
+        }
+    };
+
+    int cell_of(int coordinate) const;
+    CellRange cells(const BoundingBox& box) const;
+    bool is_oversized(const CellRange& range) const;
+
+    static uint64_t key(int cell_x, int cell_y)
+    {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(cell_x)) << 32) | static_cast<uint32_t>(cell_y);
+    }
+
+    BoundingBox to_world(const BoundingBox& box) const
+    {
+        return BoundingBox{box.left + offset_x_, box.top + offset_y_, box.right + offset_x_, box.bottom + offset_y_};
+    }
+
+    BoundingBox to_grid(const BoundingBox& box) const
+    {
+        return BoundingBox{box.left - offset_x_, box.top - offset_y_, box.right - offset_x_, box.bottom - offset_y_};
+    }
+
+    void link(uint32_t id, const CellRange& range);
+    void unlink(uint32_t id, const CellRange& range);
+
+    // box is reported only by the cell containing the top-left corner of its intersection with the area
+    bool is_reported_by(int cell_x, int cell_y, const BoundingBox& box, const BoundingBox& area) const;
+
+    int cell_size_;
+    int offset_x_ = 0;
+    int offset_y_ = 0;
+    std::vector<BoundingBox> boxes_; // grid coordinates (without offset)
+    std::vector<CellRange> ranges_;
+    std::unordered_map<uint64_t, std::vector<uint32_t>> cells_;
+    std::vector<uint32_t> oversized_;
+};
+
+#endif // SPATIAL_GRID_HPP
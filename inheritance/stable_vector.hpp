@@ -0,0 +1,192 @@
+#ifndef STABLE_VECTOR_HPP
+#define STABLE_VECTOR_HPP
+
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+// Sequence of items stored in chunks of ChunkSize items - items are constructed in place and are
+// never relocated when the sequence grows (references stay valid), so items are not copied or
+// moved by the container (e.g. shapes printing in their destructors). Indexing is a shift & a mask.
+template <typename T, size_t ChunkSize = 1024>
+class StableVector
+{
+    static_assert(ChunkSize > 0 && (ChunkSize & (ChunkSize - 1)) == 0, "ChunkSize must be a power of 2");
+
+    struct Chunk
+    {
+        alignas(T) unsigned char storage[ChunkSize * sizeof(T)];
+    };
+
+    template <typename TVector, typename TItem>
+    class Iterator
+    {
+        TVector* items_;
+        size_t index_;
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = TItem*;
+        using reference = TItem&;
+
+        Iterator(TVector* items, size_t index) : items_{items}, index_{index}
+        {}
+
+        reference operator*() const
+        {
+            return (*items_)[index_];
+        }
+
+        pointer operator->() const
+        {
+            return &(*items_)[index_];
+        }
+
+        Iterator& operator++()
+        {
+            ++index_;
+            return *this;
+        }
+
+        Iterator operator++(int)
+        {
+            Iterator it = *this;
+            ++index_;
+            return it;
+        }
+
+        bool operator==(const Iterator& other) const
+        {
+            return index_ == other.index_;
+        }
+
+        bool operator!=(const Iterator& other) const
+        {
+            return index_ != other.index_;
+        }
+    };
+
+public:
+    using value_type = T;
+    using iterator = Iterator<StableVector, T>;
+    using const_iterator = Iterator<const StableVector, const T>;
+
+    StableVector() = default;
+
+    StableVector(const StableVector&) = delete;
+    StableVector& operator=(const StableVector&) = delete;
+
+    StableVector(StableVector&& source) noexcept
+        : chunks_{std::move(source.chunks_)}, size_{std::exchange(source.size_, 0)}
+    {}
+
+    StableVector& operator=(StableVector&& source) noexcept
+    {
+        if (this != &source)
+        {
+            clear();
+            chunks_ = std::move(source.chunks_);
+            size_ = std::exchange(source.size_, 0);
+        }
+
+        return *this;
+    }
+
+    ~StableVector()
+    {
+        clear();
+    }
+
+    template <typename... TArgs>
+    T& emplace_back(TArgs&&... args)
+    {
+        if (size_ == chunks_.size() * ChunkSize)
+            chunks_.push_back(std::unique_ptr<Chunk>(new Chunk));
+
+        T* item = new (address(size_)) T(std::forward<TArgs>(args)...);
+        ++size_;
+
+        return *item;
+    }
+
+    // only the table of chunks is allocated - chunks are allocated when they are filled
+    void reserve(size_t capacity)
+    {
+        chunks_.reserve((capacity + ChunkSize - 1) / ChunkSize);
+    }
+
+    // items are destroyed in the order of insertion - like items of std::vector
+    void clear() noexcept
+    {
+        for (size_t i = 0; i < size_; ++i)
+            (*this)[i].~T();
+
+        size_ = 0;
+        chunks_.clear();
+    }
+
+    size_t size() const
+    {
+        return size_;
+    }
+
+    bool empty() const
+    {
+        return size_ == 0;
+    }
+
+    T& operator[](size_t index)
+    {
+        return *std::launder(reinterpret_cast<T*>(address(index)));
+    }
+
+    const T& operator[](size_t index) const
+    {
+        return *std::launder(reinterpret_cast<const T*>(address(index)));
+    }
+
+    T& back()
+    {
+        return (*this)[size_ - 1];
+    }
+
+    const T& back() const
+    {
+        return (*this)[size_ - 1];
+    }
+
+    iterator begin()
+    {
+        return iterator{this, 0};
+    }
+
+    iterator end()
+    {
+        return iterator{this, size_};
+    }
+
+    const_iterator begin() const
+    {
+        return const_iterator{this, 0};
+    }
+
+    const_iterator end() const
+    {
+        return const_iterator{this, size_};
+    }
+
+private:
+    unsigned char* address(size_t index) const
+    {
+        return chunks_[index / ChunkSize]->storage + (index % ChunkSize) * sizeof(T);
+    }
+
+    std::vector<std::unique_ptr<Chunk>> chunks_;
+    size_t size_ = 0;
+};
+
+#endif // STABLE_VECTOR_HPP
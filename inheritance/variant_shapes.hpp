@@ -0,0 +1,84 @@
+#ifndef VARIANT_SHAPES_HPP
+#define VARIANT_SHAPES_HPP
+
+#include "render.hpp"
+#include "shapes.hpp"
+#include "stable_vector.hpp"
+#include <cstddef>
+#include <utility>
+#include <variant>
+
+// Closed set of shapes dispatched with std::visit - shapes are the final classes
+// of the IShape hierarchy stored by value in one array (constructed in place, never relocated),
+// so calls of move() & draw() are resolved statically (no vtable lookup) and can be inlined
+namespace Variant
+{
+    using Shape = std::variant<Circle, Rectangle, Line, Polygon>;
+
+    inline void move(Shape& shape, int dx, int dy)
+    {
+        std::visit([dx, dy](auto& shp) { shp.move(dx, dy); }, shape);
+    }
+
+    inline void draw(const Shape& shape)
+    {
+        std::visit([](const auto& shp) { shp.draw(); }, shape);
+    }
+
+    inline void draw(const Shape& shape, Renderer& renderer)
+    {
+        std::visit([&renderer](const auto& shp) { shp.draw(renderer); }, shape);
+    }
+
+    // shapes are drawn in the order of adding
+    class Drawing
+    {
+        StableVector<Shape> shapes_;
+    public:
+        void add(Shape shape)
+        {
+            shapes_.emplace_back(std::move(shape));
+        }
+
+        template <typename TShape, typename... TArgs>
+        TShape& emplace(TArgs&&... args)
+        {
+            return std::get<TShape>(shapes_.emplace_back(std::in_place_type<TShape>, std::forward<TArgs>(args)...));
+        }
+
+        void reserve(size_t capacity)
+        {
+            shapes_.reserve(capacity);
+        }
+
+        size_t size() const
+        {
+            return shapes_.size();
+        }
+
+        const Shape& operator[](size_t index) const
+        {
+            return shapes_[index];
+        }
+
+        void move_all(int dx, int dy)
+        {
+            for(auto& shape : shapes_)
+                Variant::move(shape, dx, dy);
+        }
+
+        void render() const
+        {
+            for(const auto& shape : shapes_)
+                Variant::draw(shape);
+        }
+
+        void render(Renderer& renderer) const
+        {
+            for(const auto& shape : shapes_)
+                Variant::draw(shape, renderer);
+        }
+    };
+}
+
+#endif // VARIANT_SHAPES_HPP
@@ -0,0 +1,254 @@
+#include "account_store.hpp"
+#include "transaction_log.hpp"
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+using namespace std;
+using namespace Banking;
+
+namespace
+{
+    unsigned log2_ceil(size_t n)
+    {
+        unsigned bits = 0;
+        while ((size_t{1} << bits) < n)
+            ++bits;
+
+        return bits;
+    }
+
+    constexpr size_t min_no_of_slots = 16;
+}
+
+AccountStore::AccountStore(size_t no_of_shards)
+    : shard_bits_{max(1u, log2_ceil(no_of_shards))}, shards_(size_t{1} << shard_bits_)
+{
+}
+
+BankAccount& AccountStore::insert(BankAccount account)
+{
+    Shard& shard = shards_[shard_index(account.id())];
+    lock_guard<mutex> lk{shard.mtx};
+
+    return shard.insert(move(account));
+}
+
+void AccountStore::bulk_load(vector<BankAccount> accounts)
+{
+    vector<vector<size_t>> by_shard(shards_.size());
+    for (size_t i = 0; i < accounts.size(); ++i)
+        by_shard[shard_index(accounts[i].id())].push_back(i);
+
+    for (size_t s = 0; s < shards_.size(); ++s)
+    {
+        Shard& shard = shards_[s];
+        lock_guard<mutex> lk{shard.mtx};
+
+        shard.reserve(shard.accounts.size() + by_shard[s].size());
+        for (size_t i : by_shard[s])
+            shard.insert(move(accounts[i]));
+    }
+}
+
+const BankAccount* AccountStore::find(int id) const
+{
+    return shards_[shard_index(id)].find(id);
+}
+
+vector<BankAccount> AccountStore::snapshot() const
+{
+    vector<unique_lock<mutex>> locks;
+    locks.reserve(shards_.size());
+    for (const auto& shard : shards_) // always locked in the same order
+        locks.emplace_back(shard.mtx);
+
+    vector<BankAccount> accounts;
+    size_t total = 0;
+    for (const auto& shard : shards_)
+        total += shard.accounts.size();
+    accounts.reserve(total);
+
+    for (const auto& shard : shards_)
+        for (const auto& account : shard.accounts)
+            accounts.push_back(account);
+
+    return accounts;
+}
+
+void AccountStore::pay_interest(int days, size_t no_of_threads)
+{
+    const double rate = BankAccount::interest_rate();
+
+    no_of_threads = max<size_t>(1, min(no_of_threads, shards_.size()));
+
+    auto pay_interest_in_shards = [this, days, rate, no_of_threads](size_t first_shard) {
+        for (size_t s = first_shard; s < shards_.size(); s += no_of_threads)
+        {
+            Shard& shard = shards_[s];
+            lock_guard<mutex> lk{shard.mtx};
+
+            const size_t count = shard.accounts.size();
+            Money* balances = shard.balances.data();
+
+            try
+            {
+                for (size_t i = 0; i < count; ++i) // no dependencies between iterations
+                    balances[i] += BankAccount::interest(balances[i], days, rate);
+            }
+            catch (...)
+            {
+                shard.refresh_balances(); // interest is not posted to any account of the shard
+                throw;
+            }
+
+            // interest entries are appended in one pass - amounts are the increments of the column
+            for (size_t i = 0; i < count; ++i)
+                shard.accounts[i].post_interest(balances[i] - shard.accounts[i].balance_);
+        }
+    };
+
+    vector<thread> threads;
+    for (size_t t = 1; t < no_of_threads; ++t)
+        threads.emplace_back(pay_interest_in_shards, t);
+
+    pay_interest_in_shards(0);
+
+    for (auto& thd : threads)
+        thd.join();
+}
+
+size_t AccountStore::replay(const LogRecord* records, size_t count, size_t no_of_threads)
+{
+    no_of_threads = max<size_t>(1, min(no_of_threads, shards_.size()));
+
+    atomic<size_t> replayed{0};
+
+    auto replay_shards = [this, records, count, no_of_threads, &replayed](size_t thread_index) {
+        vector<unique_lock<mutex>> locks;
+        for (size_t s = thread_index; s < shards_.size(); s += no_of_threads)
+            locks.emplace_back(shards_[s].mtx);
+
+        size_t replayed_by_thread = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            const LogRecord& record = records[i];
+            const size_t s = shard_index(record.account_id);
+
+            if (s % no_of_threads != thread_index)
+                continue;
+
+            Shard& shard = shards_[s];
+            if (BankAccount* account = shard.find(record.account_id))
+            {
+                account->replay(Transaction{record.type, Money::from_units(record.amount)});
+                shard.balances[static_cast<size_t>(account - shard.accounts.data())] = account->balance();
+                ++replayed_by_thread;
+            }
+        }
+
+        replayed += replayed_by_thread;
+    };
+
+    vector<thread> threads;
+    for (size_t t = 1; t < no_of_threads; ++t)
+        threads.emplace_back(replay_shards, t);
+
+    replay_shards(0);
+
+    for (auto& thd : threads)
+        thd.join();
+
+    return replayed;
+}
+
+size_t AccountStore::size() const
+{
+    size_t total = 0;
+
+    for (const auto& shard : shards_)
+    {
+        lock_guard<mutex> lk{shard.mtx};
+        total += shard.accounts.size();
+    }
+
+    return total;
+}
+
+size_t AccountStore::Shard::find_slot(int id) const
+{
+    const size_t mask = slots.size() - 1;
+
+    for (size_t i = static_cast<size_t>(hash(id)) & mask; ; i = (i + 1) & mask)
+    {
+        if (slots[i].index == 0 || slots[i].id == id)
+            return i;
+    }
+}
+
+BankAccount* AccountStore::Shard::find(int id)
+{
+    return const_cast<BankAccount*>(static_cast<const Shard&>(*this).find(id));
+}
+
+const BankAccount* AccountStore::Shard::find(int id) const
+{
+    if (slots.empty())
+        return nullptr;
+
+    const Slot& slot = slots[find_slot(id)];
+
+    return slot.index == 0 ? nullptr : &accounts[slot.index - 1];
+}
+
+BankAccount& AccountStore::Shard::insert(BankAccount&& account)
+{
+    reserve_slots(accounts.size() + 1);
+
+    const int id = account.id();
+    Slot& slot = slots[find_slot(id)];
+    if (slot.index != 0)
+        throw invalid_argument("Account already exists: " + to_string(id));
+
+    accounts.push_back(move(account));
+    balances.push_back(accounts.back().balance());
+    slot = Slot{id, static_cast<uint32_t>(accounts.size())};
+
+    return accounts.back();
+}
+
+void AccountStore::Shard::reserve(size_t capacity)
+{
+    reserve_slots(capacity);
+    accounts.reserve(capacity);
+    balances.reserve(capacity);
+}
+
+void AccountStore::Shard::refresh_balances()
+{
+    balances.resize(accounts.size());
+    for (size_t i = 0; i < accounts.size(); ++i)
+        balances[i] = accounts[i].balance();
+}
+
+// load factor of slots is kept below 0.5
+void AccountStore::Shard::reserve_slots(size_t capacity)
+{
+    if (capacity * 2 > slots.size())
+    {
+        size_t no_of_slots = max(min_no_of_slots, slots.size());
+        while (capacity * 2 > no_of_slots)
+            no_of_slots *= 2;
+
+        rehash(no_of_slots);
+    }
+}
+
+void AccountStore::Shard::rehash(size_t no_of_slots)
+{
+    slots.assign(no_of_slots, Slot{0, 0});
+
+    for (size_t i = 0; i < accounts.size(); ++i)
+        slots[find_slot(accounts[i].id())] = Slot{accounts[i].id(), static_cast<uint32_t>(i + 1)};
+}
@@ -0,0 +1,193 @@
+#ifndef ACCOUNT_STORE_HPP
+#define ACCOUNT_STORE_HPP
+
+#include "bank_account.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Banking
+{
+    struct LogRecord;
+
+    // Accounts indexed by id() - every shard keeps accounts in a contiguous vector
+    // and an open-addressing hash table (linear probing) of (id, index) slots,
+    // so a lookup touches only the slot array and the found account.
+    // Balances of the shard are mirrored in a separate column, so bulk operations
+    // (pay_interest) scan only the balances - accounts are changed only through
+    // update()/with_shard()/for_each() which keep the column up to date.
+    // Shards are guarded by separate mutexes - use update()/for_each() for concurrent
+    // access; pointers returned by find() are invalidated by inserts into the same shard.
+    class AccountStore
+    {
+    public:
+        explicit AccountStore(size_t no_of_shards = 16);
+
+        AccountStore(const AccountStore&) = delete;
+        AccountStore& operator=(const AccountStore&) = delete;
+
+        // throws std::invalid_argument when account with the same id already exists
+        BankAccount& insert(BankAccount account);
+
+        void bulk_load(std::vector<BankAccount> accounts);
+
+        const BankAccount* find(int id) const;
+
+        bool contains(int id) const
+        {
+            const Shard& shard = shards_[shard_index(id)];
+            std::lock_guard<std::mutex> lk{shard.mtx};
+
+            return shard.find(id) != nullptr;
+        }
+
+        // calls f(account) under the lock of the shard - returns false for unknown id
+        template <typename TFunction>
+        bool update(int id, TFunction f)
+        {
+            Shard& shard = shards_[shard_index(id)];
+            std::lock_guard<std::mutex> lk{shard.mtx};
+
+            BankAccount* account = shard.find(id);
+            if (!account)
+                return false;
+
+            const size_t index = static_cast<size_t>(account - shard.accounts.data());
+            try
+            {
+                f(*account);
+            }
+            catch (...)
+            {
+                shard.balances[index] = account->balance();
+                throw;
+            }
+            shard.balances[index] = account->balance();
+
+            return true;
+        }
+
+        template <typename TFunction>
+        void for_each(TFunction f)
+        {
+            for (size_t i = 0; i < shards_.size(); ++i)
+                for_each_in_shard(i, f);
+        }
+
+        template <typename TFunction>
+        void for_each(TFunction f) const
+        {
+            for (size_t i = 0; i < shards_.size(); ++i)
+                for_each_in_shard(i, f);
+        }
+
+        // calls f(accounts) with contiguous vector of accounts in the shard (under the lock);
+        // f must not insert or erase accounts
+        template <typename TFunction>
+        void with_shard(size_t index, TFunction f)
+        {
+            Shard& shard = shards_[index];
+            std::lock_guard<std::mutex> lk{shard.mtx};
+
+            try
+            {
+                f(shard.accounts);
+            }
+            catch (...)
+            {
+                shard.refresh_balances();
+                throw;
+            }
+            shard.refresh_balances();
+        }
+
+        template <typename TFunction>
+        void for_each_in_shard(size_t index, TFunction f)
+        {
+            with_shard(index, [&f](std::vector<BankAccount>& accounts) {
+                for (auto& account : accounts)
+                    f(account);
+            });
+        }
+
+        template <typename TFunction>
+        void for_each_in_shard(size_t index, TFunction f) const
+        {
+            const Shard& shard = shards_[index];
+            std::lock_guard<std::mutex> lk{shard.mtx};
+
+            for (const auto& account : shard.accounts)
+                f(account);
+        }
+
+        // interest for all accounts - gives the same results as BankAccount::pay_interest(days)
+        // called for every account; shards are distributed among no_of_threads threads
+        void pay_interest(int days, size_t no_of_threads = std::thread::hardware_concurrency());
+
+        // applies logged transactions (recovery) - every thread scans the whole log and replays
+        // records of its shards, so transactions of an account are applied in the order of the log;
+        // returns number of replayed records (records of unknown accounts are skipped)
+        size_t replay(const LogRecord* records, size_t count,
+                      size_t no_of_threads = std::thread::hardware_concurrency());
+
+        // copy of all accounts - consistent, all shards are locked during copying
+        std::vector<BankAccount> snapshot() const;
+
+        size_t size() const;
+
+        size_t no_of_shards() const
+        {
+            return shards_.size();
+        }
+
+        size_t shard_index(int id) const
+        {
+            return static_cast<size_t>(hash(id) >> (64 - shard_bits_));
+        }
+
+    private:
+        struct Slot
+        {
+            int id;
+            uint32_t index; // index in accounts + 1 (0 - empty slot)
+        };
+
+        struct alignas(64) Shard
+        {
+            mutable std::mutex mtx;
+            std::vector<BankAccount> accounts;
+            std::vector<Money> balances; // balances[i] == accounts[i].balance()
+            std::vector<Slot> slots;
+
+            BankAccount* find(int id);
+            const BankAccount* find(int id) const;
+            BankAccount& insert(BankAccount&& account);
+            void reserve(size_t capacity);
+            void reserve_slots(size_t capacity);
+            void refresh_balances();
+
+        private:
+            size_t find_slot(int id) const;
+            void rehash(size_t no_of_slots);
+        };
+
+        static uint64_t hash(int id)
+        {
+            // finalizer of MurmurHash3 - high bits select the shard, low bits the slot
+            uint64_t h = static_cast<uint32_t>(id);
+            h ^= h >> 33;
+            h *= 0xff51afd7ed558ccdull;
+            h ^= h >> 33;
+            h *= 0xc4ceb9fe1a85ec53ull;
+            h ^= h >> 33;
+            return h;
+        }
+
+        unsigned shard_bits_;
+        std::vector<Shard> shards_;
+    };
+}
+
+#endif // ACCOUNT_STORE_HPP
@@ -6,40 +6,61 @@ using namespace std;
 using namespace Banking;
 
 // definition of interest_rate_
-double BankAccount::interest_rate_ = 0.0;
+atomic<double> BankAccount::interest_rate_{0.0};
 
-Banking::BankAccount::BankAccount(int id, const string& owner, double balance)
-    : id_{id}, owner_{owner}, balance_{balance}
+Banking::BankAccount::BankAccount(int id, const string& owner, Money balance, Timestamps timestamps)
+    : id_{id}, owner_{owner}, balance_{balance}, transactions_{timestamps}
 {
 }
 
-void BankAccount::deposit(double amount)
+void BankAccount::deposit(Money amount)
 {
-    assert(amount > 0.0);
+    assert(amount > Money{});
     balance_ += amount;
 
-    transactions_.push_back(Transaction{TransactionType::deposit, amount});
+    transactions_.append(Transaction{TransactionType::deposit, amount});
 }
 
-void BankAccount::withdraw(double amount)
+void BankAccount::withdraw(Money amount)
 {
-    assert(amount > 0.0);
+    assert(amount > Money{});
 
     if (amount > balance_)
         throw InsufficientFundsError{id_, balance_, amount};
 
     balance_ -= amount;
 
-    transactions_.push_back(Transaction{TransactionType::withdraw, amount});
+    transactions_.append(Transaction{TransactionType::withdraw, amount});
 }
 
 void BankAccount::pay_interest(int days)
 {
-    double factor = days / 365.0;
-    double interest = balance() * factor * interest_rate_;
+    post_interest(interest(balance(), days, interest_rate()));
+}
+
+void BankAccount::post_interest(Money interest)
+{
     balance_ += interest;
 
-    transactions_.push_back({TransactionType::interest, interest});
+    transactions_.append({TransactionType::interest, interest});
+}
+
+void BankAccount::replay(const Transaction& t)
+{
+    switch (t.type)
+    {
+        case TransactionType::deposit:
+            balance_ += t.amount;
+            break;
+        case TransactionType::withdraw:
+            balance_ -= t.amount;
+            break;
+        case TransactionType::interest:
+            balance_ += t.amount;
+            break;
+    }
+
+    transactions_.append(t);
 }
 
 namespace Banking
@@ -1,44 +1,30 @@
 #ifndef BANK_ACCOUNT_HPP
 #define BANK_ACCOUNT_HPP
 
+#include "ledger.hpp"
+#include "money.hpp"
+#include "transaction.hpp"
+#include <atomic>
+#include <memory>
 #include <string>
-#include <vector>
+#include <string_view>
 #include <ostream>
 
 namespace Banking
 {
-    enum class TransactionType : char
-    {
-        interest = 'I', withdraw = 'W', deposit = 'D'
-    };
-
-    struct Transaction
+    struct InsufficientFundsError
     {
-        TransactionType type;
-        double amount;
+        const int account_id;
+        const Money account_balance;
+        const Money amount;
     };
 
-    inline bool operator==(const Transaction& left, const Transaction& right)
-    {
-        return left.type == right.type && left.amount == right.amount;
-    }
-
-    inline bool operator!=(const Transaction& left, const Transaction& right)
-    {
-        return !(left == right);
-    }
-
-    inline std::ostream& operator<<(std::ostream& stream_out, const Transaction& t)
-    {
-        stream_out << "Transaction{type: " << static_cast<char>(t.type) << ", amount: " << t.amount << "}";
-        return stream_out;
-    }
-
-    struct InsufficientFundsError
+    // state of the account before the first resident transaction
+    struct Checkpoint
     {
-        const int account_id;
-        const double account_balance;
-        const double amount;
+        size_t position;
+        Money balance;
+        Ledger::Totals totals;
     };
 
     class BankAccount
@@ -46,44 +32,83 @@ namespace Banking
     public:
         static void set_interest_rate(double rate)
         {
-            interest_rate_ = rate;
+            interest_rate_.store(rate, std::memory_order_relaxed);
+        }
+
+        static double interest_rate()
+        {
+            return interest_rate_.load(std::memory_order_relaxed);
+        }
+
+        // interest for the balance rounded to the minor unit - the only formula of interest,
+        // shared by all interest paths (single account, AccountStore & ConcurrentBankAccount)
+        static Money interest(Money balance, int days, double rate)
+        {
+            return Money::from_double(balance.to_double() * (days / 365.0) * rate, Rounding::half_even);
         }
 
         // constructor
         BankAccount(int id, const std::string& owner,
-            double balance);
+            Money balance, Timestamps timestamps = Timestamps::off);
 
         int id() const
         {
             return id_;
         }
 
-        std::string owner() const
+        std::string_view owner() const
         {
             return owner_;
         }
 
-        double balance() const
+        Money balance() const
         {
             return balance_;
         }
 
-        void deposit(double amount);
+        void deposit(Money amount);
 
-        void withdraw(double amount);
+        void withdraw(Money amount);
 
         void pay_interest(int days);
 
-        const std::vector<Transaction>& transactions() const
+        const Ledger& transactions() const
         {
             return transactions_;
         }
+
+        // balance after the first position transactions (0 - opening balance)
+        Money balance_at(size_t position) const
+        {
+            return balance_ - transactions_.totals(position, transactions_.size()).net();
+        }
+
+        // keeps only keep_last transactions in memory - older ones are folded into the checkpoint
+        // and moved to the cold storage (dropped when cold is nullptr); see Ledger::compact()
+        void compact_history(size_t keep_last, std::shared_ptr<ColdStorage> cold = nullptr)
+        {
+            transactions_.compact(keep_last, std::move(cold));
+        }
+
+        Checkpoint checkpoint() const
+        {
+            const size_t position = transactions_.compacted();
+            return Checkpoint{position, balance_at(position), transactions_.compacted_totals()};
+        }
     private:
+        friend class AccountStore; // bulk interest payment & recovery
+
+        // interest calculated in bulk - see AccountStore::pay_interest()
+        void post_interest(Money interest);
+
+        // applies logged transaction - see AccountStore::replay()
+        void replay(const Transaction& t);
+
         const int id_;
         std::string owner_;
-        double balance_;
-        std::vector<Transaction> transactions_;
-        static double interest_rate_; // declaration
+        Money balance_;
+        Ledger transactions_;
+        static std::atomic<double> interest_rate_; // declaration
     };
 
     void print(const BankAccount& account);
@@ -0,0 +1,163 @@
+#include "batch_processing.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+using namespace std;
+using namespace Banking;
+
+namespace
+{
+    struct FailedOperation
+    {
+        size_t index;
+        Money account_balance;
+    };
+
+    struct ShardResult
+    {
+        size_t applied = 0;
+        vector<FailedOperation> failed_operations;
+    };
+
+    void apply(const Operation* operations, size_t index, BankAccount& account, ShardResult& result)
+    {
+        const Operation& op = operations[index];
+
+        switch (op.type)
+        {
+            case TransactionType::deposit:
+                account.deposit(op.amount);
+                break;
+            case TransactionType::withdraw:
+                if (op.amount > account.balance())
+                {
+                    result.failed_operations.push_back(FailedOperation{index, account.balance()});
+                    return;
+                }
+                account.withdraw(op.amount);
+                break;
+            case TransactionType::interest:
+                account.pay_interest(op.days);
+                break;
+        }
+
+        ++result.applied;
+    }
+
+    // process_shard(i, result) is called for every shard - the first shard is processed by the calling thread
+    template <typename TProcessShard>
+    vector<ShardResult> process_in_parallel(size_t no_of_shards, TProcessShard process_shard)
+    {
+        vector<ShardResult> shard_results(no_of_shards);
+        vector<thread> threads;
+
+        for (size_t i = 1; i < no_of_shards; ++i)
+            threads.emplace_back([&, i] { process_shard(i, shard_results[i]); });
+
+        process_shard(0, shard_results[0]);
+
+        for (auto& thd : threads)
+            thd.join();
+
+        return shard_results;
+    }
+
+    BatchResult merge(const Operation* operations, const vector<ShardResult>& shard_results)
+    {
+        BatchResult result;
+        vector<FailedOperation> failed_operations;
+
+        for (const auto& shard_result : shard_results)
+        {
+            result.applied += shard_result.applied;
+            failed_operations.insert(failed_operations.end(),
+                                     shard_result.failed_operations.begin(), shard_result.failed_operations.end());
+        }
+
+        sort(failed_operations.begin(), failed_operations.end(),
+             [](const FailedOperation& a, const FailedOperation& b) { return a.index < b.index; });
+
+        result.failures.reserve(failed_operations.size());
+        for (const auto& failed : failed_operations)
+        {
+            const Operation& op = operations[failed.index];
+            result.failures.push_back(BatchFailure{failed.index, InsufficientFundsError{op.account_id, failed.account_balance, op.amount}});
+        }
+
+        return result;
+    }
+
+    [[noreturn]] void throw_unknown_account(int account_id)
+    {
+        throw invalid_argument("Unknown account id: " + to_string(account_id));
+    }
+}
+
+BatchResult Banking::process_batch(const Operation* operations, size_t count, vector<BankAccount>& accounts,
+                                   size_t no_of_shards)
+{
+    no_of_shards = max<size_t>(1, min(no_of_shards, accounts.size()));
+
+    unordered_map<int, size_t> account_index;
+    account_index.reserve(accounts.size());
+    for (size_t i = 0; i < accounts.size(); ++i)
+        account_index.emplace(accounts[i].id(), i);
+
+    // grouping operations by shard & account
+    vector<BankAccount*> targets(count);
+    vector<vector<size_t>> shards(no_of_shards);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        auto it = account_index.find(operations[i].account_id);
+        if (it == account_index.end())
+            throw_unknown_account(operations[i].account_id);
+
+        targets[i] = &accounts[it->second];
+        shards[it->second % no_of_shards].push_back(i);
+    }
+
+    for (auto& shard : shards)
+        stable_sort(shard.begin(), shard.end(),
+                    [&targets](size_t a, size_t b) { return targets[a] < targets[b]; });
+
+    auto shard_results = process_in_parallel(no_of_shards, [&](size_t shard, ShardResult& result) {
+        for (size_t index : shards[shard])
+            apply(operations, index, *targets[index], result);
+    });
+
+    return merge(operations, shard_results);
+}
+
+BatchResult Banking::process_batch(const Operation* operations, size_t count, AccountStore& store,
+                                   size_t no_of_threads)
+{
+    no_of_threads = max<size_t>(1, min(no_of_threads, store.no_of_shards()));
+
+    // shards of the store are assigned to threads - every shard is updated by one thread only
+    vector<vector<size_t>> groups(no_of_threads);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const int account_id = operations[i].account_id;
+        if (!store.contains(account_id))
+            throw_unknown_account(account_id);
+
+        groups[store.shard_index(account_id) % no_of_threads].push_back(i);
+    }
+
+    for (auto& group : groups)
+        stable_sort(group.begin(), group.end(), [operations](size_t a, size_t b) {
+            return operations[a].account_id < operations[b].account_id;
+        });
+
+    auto shard_results = process_in_parallel(no_of_threads, [&](size_t group, ShardResult& result) {
+        for (size_t index : groups[group])
+            store.update(operations[index].account_id,
+                         [&](BankAccount& account) { apply(operations, index, account, result); });
+    });
+
+    return merge(operations, shard_results);
+}
@@ -0,0 +1,58 @@
+#ifndef BATCH_PROCESSING_HPP
+#define BATCH_PROCESSING_HPP
+
+#include "account_store.hpp"
+#include "bank_account.hpp"
+#include "transaction.hpp"
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace Banking
+{
+    struct Operation
+    {
+        int account_id;
+        TransactionType type;
+        Money amount;  // ignored for TransactionType::interest
+        int days = 0;  // for TransactionType::interest
+    };
+
+    struct BatchFailure
+    {
+        size_t operation_index;
+        InsufficientFundsError error;
+    };
+
+    struct BatchResult
+    {
+        size_t applied = 0;
+        std::vector<BatchFailure> failures; // ordered by operation_index
+    };
+
+    // Operations are grouped by account and applied in parallel - accounts are split into
+    // no_of_shards disjoint shards processed by separate threads. Operations of the same
+    // account are applied in the order of the batch. Withdrawals exceeding the balance are
+    // skipped and reported in the result. Throws std::invalid_argument (before any change)
+    // when an operation refers to an unknown account.
+    BatchResult process_batch(const Operation* operations, size_t count, std::vector<BankAccount>& accounts,
+                              size_t no_of_shards = std::thread::hardware_concurrency());
+
+    inline BatchResult process_batch(const std::vector<Operation>& operations, std::vector<BankAccount>& accounts,
+                                     size_t no_of_shards = std::thread::hardware_concurrency())
+    {
+        return process_batch(operations.data(), operations.size(), accounts, no_of_shards);
+    }
+
+    // shards of the store are distributed among no_of_threads threads
+    BatchResult process_batch(const Operation* operations, size_t count, AccountStore& store,
+                              size_t no_of_threads = std::thread::hardware_concurrency());
+
+    inline BatchResult process_batch(const std::vector<Operation>& operations, AccountStore& store,
+                                     size_t no_of_threads = std::thread::hardware_concurrency())
+    {
+        return process_batch(operations.data(), operations.size(), store, no_of_threads);
+    }
+}
+
+#endif // BATCH_PROCESSING_HPP
@@ -0,0 +1,97 @@
+#include "cold_storage.hpp"
+#include <cerrno>
+#include <system_error>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace std;
+using namespace Banking;
+
+namespace
+{
+    [[noreturn]] void throw_system_error(const string& what)
+    {
+        throw system_error(errno, generic_category(), what);
+    }
+}
+
+ColdStorage::ColdStorage(const string& path)
+{
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd_ == -1)
+        throw_system_error("open: " + path);
+}
+
+ColdStorage::~ColdStorage()
+{
+    ::close(fd_);
+}
+
+size_t ColdStorage::append(const TransactionType* types, const Money* amounts, const Clock::time_point* timestamps,
+                           size_t count)
+{
+    vector<ColdRecord> records(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        records[i].type = types[i];
+        records[i].amount = amounts[i].units();
+        records[i].timestamp = timestamps ? timestamps[i].time_since_epoch().count() : 0;
+    }
+
+    lock_guard<mutex> lk{mtx_};
+
+    const char* data = reinterpret_cast<const char*>(records.data());
+    size_t bytes = count * sizeof(ColdRecord);
+    off_t offset = static_cast<off_t>(size_ * sizeof(ColdRecord));
+
+    while (bytes > 0)
+    {
+        ssize_t written = ::pwrite(fd_, data, bytes, offset);
+        if (written == -1)
+        {
+            if (errno == EINTR)
+                continue;
+            throw_system_error("pwrite");
+        }
+
+        data += written;
+        bytes -= static_cast<size_t>(written);
+        offset += written;
+    }
+
+    const size_t first = size_;
+    size_ += count;
+
+    return first;
+}
+
+void ColdStorage::read(size_t index, size_t count, ColdRecord* records) const
+{
+    char* data = reinterpret_cast<char*>(records);
+    size_t bytes = count * sizeof(ColdRecord);
+    off_t offset = static_cast<off_t>(index * sizeof(ColdRecord));
+
+    while (bytes > 0)
+    {
+        ssize_t read = ::pread(fd_, data, bytes, offset);
+        if (read == -1)
+        {
+            if (errno == EINTR)
+                continue;
+            throw_system_error("pread");
+        }
+        if (read == 0)
+            throw out_of_range("Record beyond the end of cold storage");
+
+        data += read;
+        bytes -= static_cast<size_t>(read);
+        offset += read;
+    }
+}
+
+size_t ColdStorage::size() const
+{
+    lock_guard<mutex> lk{mtx_};
+    return size_;
+}
@@ -0,0 +1,60 @@
+#ifndef COLD_STORAGE_HPP
+#define COLD_STORAGE_HPP
+
+#include "transaction.hpp"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+namespace Banking
+{
+    struct ColdRecord
+    {
+        TransactionType type;
+        char padding[7];
+        int64_t amount;    // Money::units()
+        int64_t timestamp; // ticks of Clock since epoch - 0 when timestamps are off
+    };
+
+    static_assert(sizeof(ColdRecord) == 24, "Cold storage format must not depend on padding");
+
+    // Append-only file of transactions compacted out of ledgers (see Ledger::compact()) -
+    // records are read on demand (pread). One storage may be shared by many ledgers.
+    class ColdStorage
+    {
+    public:
+        using Clock = std::chrono::system_clock;
+
+        // existing file is truncated
+        explicit ColdStorage(const std::string& path);
+
+        ColdStorage(const ColdStorage&) = delete;
+        ColdStorage& operator=(const ColdStorage&) = delete;
+
+        ~ColdStorage();
+
+        // timestamps may be nullptr - returns index of the first appended record
+        size_t append(const TransactionType* types, const Money* amounts, const Clock::time_point* timestamps,
+                      size_t count);
+
+        void read(size_t index, size_t count, ColdRecord* records) const;
+
+        ColdRecord read(size_t index) const
+        {
+            ColdRecord record;
+            read(index, 1, &record);
+            return record;
+        }
+
+        size_t size() const;
+
+    private:
+        int fd_;
+        size_t size_ = 0;
+        mutable std::mutex mtx_;
+    };
+}
+
+#endif // COLD_STORAGE_HPP
@@ -0,0 +1,48 @@
+#include "concurrent_bank_account.hpp"
+#include <cassert>
+
+using namespace std;
+using namespace Banking;
+
+ConcurrentBankAccount::ConcurrentBankAccount(int id, const string& owner, Money balance)
+    : id_{id}, owner_{owner}, balance_{balance.units()}
+{
+}
+
+void ConcurrentBankAccount::deposit(Money amount)
+{
+    assert(amount > Money{});
+
+    balance_.fetch_add(amount.units(), memory_order_acq_rel); // integer - no CAS loop
+
+    transactions_.append(Transaction{TransactionType::deposit, amount});
+}
+
+void ConcurrentBankAccount::withdraw(Money amount)
+{
+    assert(amount > Money{});
+
+    int64_t current = balance_.load(memory_order_relaxed);
+    do
+    {
+        if (amount.units() > current)
+            throw InsufficientFundsError{id_, Money::from_units(current), amount};
+    } while (!balance_.compare_exchange_weak(current, current - amount.units(), memory_order_acq_rel));
+
+    transactions_.append(Transaction{TransactionType::withdraw, amount});
+}
+
+void ConcurrentBankAccount::pay_interest(int days)
+{
+    const double rate = BankAccount::interest_rate();
+
+    int64_t current = balance_.load(memory_order_relaxed);
+    Money interest;
+    do
+    {
+        // calculated for the balance that is updated
+        interest = BankAccount::interest(Money::from_units(current), days, rate);
+    } while (!balance_.compare_exchange_weak(current, current + interest.units(), memory_order_acq_rel));
+
+    transactions_.append(Transaction{TransactionType::interest, interest});
+}
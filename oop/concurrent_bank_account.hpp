@@ -0,0 +1,59 @@
+#ifndef CONCURRENT_BANK_ACCOUNT_HPP
+#define CONCURRENT_BANK_ACCOUNT_HPP
+
+#include "bank_account.hpp"
+#include "concurrent_ledger.hpp"
+#include <atomic>
+#include <string>
+#include <string_view>
+
+namespace Banking
+{
+    // Thread-safe variant of BankAccount - balance (in minor units) is updated atomically (no mutex),
+    // transactions are logged to per-thread buffers of ConcurrentLedger.
+    // Interest rate is shared with BankAccount (BankAccount::set_interest_rate()).
+    class ConcurrentBankAccount
+    {
+    public:
+        ConcurrentBankAccount(int id, const std::string& owner, Money balance);
+
+        ConcurrentBankAccount(const ConcurrentBankAccount&) = delete;
+        ConcurrentBankAccount& operator=(const ConcurrentBankAccount&) = delete;
+
+        int id() const
+        {
+            return id_;
+        }
+
+        std::string_view owner() const
+        {
+            return owner_;
+        }
+
+        Money balance() const
+        {
+            return Money::from_units(balance_.load(std::memory_order_acquire));
+        }
+
+        void deposit(Money amount);
+
+        void withdraw(Money amount);
+
+        void pay_interest(int days);
+
+        // merged snapshot of transactions - ordered by the moment of logging, so concurrent
+        // operations may be listed in a different order than the balance was updated
+        Ledger transactions() const
+        {
+            return transactions_.snapshot();
+        }
+
+    private:
+        const int id_;
+        const std::string owner_;
+        alignas(64) std::atomic<int64_t> balance_; // minor units; own cache line - hot accounts
+        ConcurrentLedger transactions_;
+    };
+}
+
+#endif // CONCURRENT_BANK_ACCOUNT_HPP
@@ -0,0 +1,163 @@
+#include "concurrent_ledger.hpp"
+#include <algorithm>
+#include <array>
+#include <utility>
+
+using namespace std;
+using namespace Banking;
+
+// chunked buffer written by a single thread - readers see records published by size_
+class ConcurrentLedger::Buffer
+{
+    static constexpr size_t chunk_size = 256;
+
+    struct Chunk
+    {
+        Record records[chunk_size];
+        Chunk* next = nullptr;
+    };
+
+    const thread::id owner_;
+    Chunk* head_;
+    Chunk* tail_;
+    atomic<size_t> size_{0};
+
+public:
+    explicit Buffer(thread::id owner)
+        : owner_{owner}, head_{new Chunk}, tail_{head_}
+    {}
+
+    Buffer(const Buffer&) = delete;
+    Buffer& operator=(const Buffer&) = delete;
+
+    ~Buffer()
+    {
+        while (head_ != nullptr)
+            delete exchange(head_, head_->next);
+    }
+
+    thread::id owner() const
+    {
+        return owner_;
+    }
+
+    size_t size() const
+    {
+        return size_.load(memory_order_acquire);
+    }
+
+    // called only by the owner thread
+    void push(const Record& record)
+    {
+        const size_t size = size_.load(memory_order_relaxed);
+
+        if (size > 0 && size % chunk_size == 0)
+        {
+            tail_->next = new Chunk;
+            tail_ = tail_->next;
+        }
+
+        tail_->records[size % chunk_size] = record;
+        size_.store(size + 1, memory_order_release); // publishes the record (and the new chunk)
+    }
+
+    void copy_to(vector<Record>& records) const
+    {
+        const size_t size = this->size();
+
+        const Chunk* chunk = head_;
+        for (size_t i = 0; i < size; ++i)
+        {
+            if (i > 0 && i % chunk_size == 0)
+                chunk = chunk->next;
+
+            records.push_back(chunk->records[i % chunk_size]);
+        }
+    }
+};
+
+namespace
+{
+    atomic<uint64_t> next_ledger_id{1};
+}
+
+ConcurrentLedger::ConcurrentLedger()
+    : id_{next_ledger_id.fetch_add(1, memory_order_relaxed)}
+{
+}
+
+ConcurrentLedger::~ConcurrentLedger() = default;
+
+void ConcurrentLedger::append(const Transaction& t)
+{
+    const uint64_t sequence = sequence_.fetch_add(1, memory_order_relaxed);
+
+    local_buffer()->push(Record{sequence, t});
+}
+
+ConcurrentLedger::Buffer* ConcurrentLedger::local_buffer()
+{
+    struct CacheEntry
+    {
+        uint64_t ledger_id;
+        Buffer* buffer;
+    };
+
+    // ids of ledgers are never reused - entries of destroyed ledgers do not match
+    thread_local array<CacheEntry, 16> cache{};
+
+    CacheEntry& entry = cache[id_ % cache.size()];
+    if (entry.ledger_id == id_)
+        return entry.buffer;
+
+    const thread::id this_thread_id = this_thread::get_id();
+
+    lock_guard<mutex> lk{mtx_buffers_};
+
+    auto it = find_if(buffers_.begin(), buffers_.end(),
+                      [this_thread_id](const auto& buffer) { return buffer->owner() == this_thread_id; });
+
+    if (it == buffers_.end())
+    {
+        buffers_.push_back(make_unique<Buffer>(this_thread_id));
+        it = prev(buffers_.end());
+    }
+
+    entry = CacheEntry{id_, it->get()};
+
+    return entry.buffer;
+}
+
+Ledger ConcurrentLedger::snapshot() const
+{
+    vector<Record> records;
+
+    {
+        lock_guard<mutex> lk{mtx_buffers_};
+
+        for (const auto& buffer : buffers_)
+            buffer->copy_to(records);
+    }
+
+    sort(records.begin(), records.end(),
+         [](const Record& a, const Record& b) { return a.sequence < b.sequence; });
+
+    Ledger ledger;
+    ledger.reserve(records.size());
+    for (const auto& record : records)
+        ledger.append(record.transaction);
+
+    return ledger;
+}
+
+size_t ConcurrentLedger::size() const
+{
+    lock_guard<mutex> lk{mtx_buffers_};
+
+    size_t size = 0;
+
+    for (const auto& buffer : buffers_)
+        size += buffer->size();
+
+    return size;
+}
@@ -0,0 +1,54 @@
+#ifndef CONCURRENT_LEDGER_HPP
+#define CONCURRENT_LEDGER_HPP
+
+#include "ledger.hpp"
+#include "transaction.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Banking
+{
+    // Append-only log of transactions written concurrently by many threads.
+    // Every thread appends to its own buffer (single producer - no locks, no CAS),
+    // buffers are merged by sequence number on read. Only the first append of
+    // a thread to the ledger registers its buffer under a mutex.
+    class ConcurrentLedger
+    {
+    public:
+        ConcurrentLedger();
+
+        ConcurrentLedger(const ConcurrentLedger&) = delete;
+        ConcurrentLedger& operator=(const ConcurrentLedger&) = delete;
+
+        ~ConcurrentLedger();
+
+        void append(const Transaction& t);
+
+        // transactions appended so far, ordered by the moment of logging
+        Ledger snapshot() const;
+
+        size_t size() const;
+
+    private:
+        struct Record
+        {
+            uint64_t sequence;
+            Transaction transaction;
+        };
+
+        class Buffer;
+
+        Buffer* local_buffer();
+
+        const uint64_t id_;
+        std::atomic<uint64_t> sequence_{0};
+        mutable std::mutex mtx_buffers_;
+        std::vector<std::unique_ptr<Buffer>> buffers_;
+    };
+}
+
+#endif // CONCURRENT_LEDGER_HPP
@@ -0,0 +1,187 @@
+#include "formatting.hpp"
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <string_view>
+
+using namespace std;
+using namespace Banking;
+
+namespace
+{
+    constexpr size_t max_int_chars = numeric_limits<int>::digits10 + 2;
+
+    // "  Transaction{type: D, amount: 1.5}\n"
+    constexpr size_t max_transaction_line = 40 + Money::max_chars;
+
+    // "BankAccount{id: 1, owner: , balance: 1.5}\n" + owner
+    constexpr size_t max_account_line = 40 + max_int_chars + Money::max_chars;
+
+    // Sequential writes into [first, last) - stops at the first write that does not fit.
+    // Checked == false when the caller has already verified that the buffer is large enough.
+    template <bool Checked>
+    class Output
+    {
+    public:
+        Output(char* first, char* last)
+            : pos_{first}, last_{last}
+        {}
+
+        Output& operator()(string_view text)
+        {
+            if (fits(text.size()))
+                pos_ = copy(text.begin(), text.end(), pos_);
+
+            return *this;
+        }
+
+        // literals - length known at compile time, copied inline
+        template <size_t N>
+        Output& operator()(const char (&text)[N])
+        {
+            if (fits(N - 1))
+                pos_ = copy_n(text, N - 1, pos_);
+
+            return *this;
+        }
+
+        Output& operator()(char c)
+        {
+            if (fits(1))
+                *pos_++ = c;
+
+            return *this;
+        }
+
+        Output& operator()(int value)
+        {
+            return append(std::to_chars(pos_, last_, value));
+        }
+
+        Output& operator()(Money amount)
+        {
+            return append(Banking::to_chars(pos_, last_, amount));
+        }
+
+        to_chars_result result() const
+        {
+            if (failed_)
+                return {last_, errc::value_too_large};
+
+            return {pos_, errc{}};
+        }
+
+    private:
+        bool fits(size_t size)
+        {
+            if (Checked && (failed_ || static_cast<size_t>(last_ - pos_) < size))
+                failed_ = true;
+
+            return !failed_;
+        }
+
+        Output& append(to_chars_result result)
+        {
+            if (!failed_ && result.ec == errc{})
+                pos_ = result.ptr;
+            else
+                failed_ = true;
+
+            return *this;
+        }
+
+        char* pos_;
+        char* last_;
+        bool failed_ = false;
+    };
+
+    template <typename TOutput>
+    void format(TOutput& out, const Transaction& t)
+    {
+        out("Transaction{type: ")(static_cast<char>(t.type))(", amount: ")(t.amount)('}');
+    }
+
+    template <typename TOutput>
+    void format(TOutput& out, const BankAccount& account)
+    {
+        out("BankAccount{id: ")(account.id())(", owner: ")(account.owner())(", balance: ")(account.balance())('}');
+    }
+
+    template <typename TOutput>
+    to_chars_result format_statement(TOutput out, const BankAccount& account)
+    {
+        format(out, account);
+        out('\n');
+
+        for (const Transaction& t : account.transactions())
+        {
+            out("  ");
+            format(out, t);
+            out('\n');
+        }
+
+        return out.result();
+    }
+}
+
+to_chars_result Banking::to_chars(char* first, char* last, const Transaction& t)
+{
+    Output<true> out{first, last};
+    format(out, t);
+
+    return out.result();
+}
+
+to_chars_result Banking::to_chars(char* first, char* last, const BankAccount& account)
+{
+    Output<true> out{first, last};
+    format(out, account);
+
+    return out.result();
+}
+
+to_chars_result Banking::format_statement(char* first, char* last, const BankAccount& account)
+{
+    const size_t max_size = max_account_line + account.owner().size()
+                            + account.transactions().size() * max_transaction_line;
+
+    // checks of the remaining space are skipped when the longest possible statement fits
+    if (static_cast<size_t>(last - first) >= max_size)
+        return ::format_statement(Output<false>{first, last}, account);
+
+    return ::format_statement(Output<true>{first, last}, account);
+}
+
+void Banking::print_statement(ostream& out, const BankAccount& account)
+{
+    out << account << '\n';
+
+    for (const Transaction& t : account.transactions())
+        out << "  " << t << '\n';
+}
+
+void Banking::write_statements(ostream& out, const BankAccount* accounts, size_t count)
+{
+    array<char, 64 * 1024> buffer;
+    char* const last = buffer.data() + buffer.size();
+    char* pos = buffer.data();
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        to_chars_result result = format_statement(pos, last, accounts[i]);
+
+        if (result.ec != errc{} && pos != buffer.data()) // buffer is full - flush & retry
+        {
+            out.write(buffer.data(), pos - buffer.data());
+            pos = buffer.data();
+            result = format_statement(pos, last, accounts[i]);
+        }
+
+        if (result.ec == errc{})
+            pos = result.ptr;
+        else
+            print_statement(out, accounts[i]); // statement larger than the buffer
+    }
+
+    out.write(buffer.data(), pos - buffer.data());
+}
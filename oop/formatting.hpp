@@ -0,0 +1,36 @@
+#ifndef FORMATTING_HPP
+#define FORMATTING_HPP
+
+#include "bank_account.hpp"
+#include "money.hpp"
+#include "transaction.hpp"
+#include <charconv>
+#include <cstddef>
+#include <ostream>
+#include <vector>
+
+namespace Banking
+{
+    // Formatting into caller-provided buffers - no allocations, the same text as operator<<.
+    // Like std::to_chars: returns {end of text, errc{}} or {last, errc::value_too_large}
+    // when the text does not fit (contents of the buffer are unspecified then).
+    std::to_chars_result to_chars(char* first, char* last, const Transaction& t);
+
+    std::to_chars_result to_chars(char* first, char* last, const BankAccount& account);
+
+    // statement - account line followed by indented lines of transactions
+    std::to_chars_result format_statement(char* first, char* last, const BankAccount& account);
+
+    // the same text as format_statement() written with operator<<
+    void print_statement(std::ostream& out, const BankAccount& account);
+
+    // statements are formatted into a fixed-size buffer that is written to out in large blocks
+    void write_statements(std::ostream& out, const BankAccount* accounts, size_t count);
+
+    inline void write_statements(std::ostream& out, const std::vector<BankAccount>& accounts)
+    {
+        write_statements(out, accounts.data(), accounts.size());
+    }
+}
+
+#endif // FORMATTING_HPP
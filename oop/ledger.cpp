@@ -0,0 +1,179 @@
+#include "ledger.hpp"
+#include "cold_storage.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+using namespace Banking;
+
+namespace
+{
+    // new vector without count first items - capacity is trimmed to the size
+    template <typename T>
+    void drop_front(vector<T>& items, size_t count)
+    {
+        vector<T>(items.begin() + count, items.end()).swap(items);
+    }
+
+    [[noreturn]] void throw_dropped(size_t index)
+    {
+        throw out_of_range("Transaction " + to_string(index) + " was compacted without cold storage");
+    }
+}
+
+void Ledger::append(const Transaction& t)
+{
+    if (with_timestamps_)
+        append(t, Clock::now());
+    else
+    {
+        index(t);
+        types_.push_back(t.type);
+        amounts_.push_back(t.amount);
+    }
+}
+
+void Ledger::append(const Transaction& t, Clock::time_point timestamp)
+{
+    index(t);
+    types_.push_back(t.type);
+    amounts_.push_back(t.amount);
+
+    if (with_timestamps_)
+        timestamps_.push_back(timestamp);
+}
+
+void Ledger::reserve(size_t capacity)
+{
+    types_.reserve(capacity);
+    amounts_.reserve(capacity);
+    checkpoints_.reserve(capacity / checkpoint_interval + 1);
+
+    if (with_timestamps_)
+        timestamps_.reserve(capacity);
+}
+
+Ledger::Totals Ledger::totals_before(size_t position) const
+{
+    if (position >= size())
+        return totals_;
+
+    if (position < compacted_)
+    {
+        const size_t checkpoint = position / checkpoint_interval;
+        Totals totals = cold_checkpoints_[checkpoint];
+        add_compacted(totals, checkpoint * checkpoint_interval, position);
+        return totals;
+    }
+
+    const size_t offset = position - compacted_;
+    const size_t checkpoint = offset / checkpoint_interval;
+    Totals totals = checkpoints_[checkpoint];
+
+    for (size_t i = checkpoint * checkpoint_interval; i < offset; ++i)
+        totals.add(types_[i], amounts_[i]);
+
+    return totals;
+}
+
+void Ledger::compact(size_t keep_last, shared_ptr<ColdStorage> cold)
+{
+    if (keep_last >= resident())
+        return;
+
+    const size_t count = resident() - keep_last;
+
+    if (cold)
+    {
+        const size_t record = cold->append(types_.data(), amounts_.data(),
+                                           with_timestamps_ ? timestamps_.data() : nullptr, count);
+        cold_segments_.push_back(ColdSegment{move(cold), compacted_, record, count});
+    }
+
+    // checkpoints of the compacted range are kept - they do not depend on the boundary
+    cold_checkpoints_.reserve((compacted_ + count) / checkpoint_interval + 1);
+    for (size_t i = 0; i < count; ++i)
+    {
+        if ((compacted_ + i) % checkpoint_interval == 0)
+            cold_checkpoints_.push_back(compacted_totals_);
+        compacted_totals_.add(types_[i], amounts_[i]);
+    }
+    compacted_ += count;
+
+    drop_front(types_, count);
+    drop_front(amounts_, count);
+    if (with_timestamps_)
+        drop_front(timestamps_, count);
+
+    // checkpoints are rebuilt relative to the new boundary
+    checkpoints_.clear();
+    Totals totals = compacted_totals_;
+    for (size_t i = 0; i < amounts_.size(); ++i)
+    {
+        if (i % checkpoint_interval == 0)
+            checkpoints_.push_back(totals);
+        totals.add(types_[i], amounts_[i]);
+    }
+    checkpoints_.shrink_to_fit();
+}
+
+const Ledger::ColdSegment& Ledger::cold_segment(size_t index) const
+{
+    auto segment = upper_bound(cold_segments_.begin(), cold_segments_.end(), index,
+                               [](size_t index, const ColdSegment& s) { return index < s.position; });
+
+    if (segment == cold_segments_.begin() || index >= (--segment)->position + segment->count)
+        throw_dropped(index);
+
+    return *segment;
+}
+
+pair<Transaction, Ledger::Clock::time_point> Ledger::read_compacted(size_t index) const
+{
+    const ColdSegment& segment = cold_segment(index);
+    const ColdRecord record = segment.storage->read(segment.record + (index - segment.position));
+
+    return {Transaction{record.type, Money::from_units(record.amount)},
+            Clock::time_point{Clock::duration{record.timestamp}}};
+}
+
+void Ledger::add_compacted(Totals& totals, size_t first, size_t last) const
+{
+    ColdRecord records[checkpoint_interval];
+
+    for (size_t position = first; position < last;)
+    {
+        const ColdSegment& segment = cold_segment(position);
+
+        const size_t segment_end = min(last, segment.position + segment.count);
+        while (position < segment_end)
+        {
+            const size_t count = min(segment_end - position, std::size(records));
+            segment.storage->read(segment.record + (position - segment.position), count, records);
+
+            for (size_t i = 0; i < count; ++i)
+                totals.add(records[i].type, Money::from_units(records[i].amount));
+
+            position += count;
+        }
+    }
+}
+
+// O(1) - checkpoint is stored before the first entry of every block
+void Ledger::index(const Transaction& t)
+{
+    if (amounts_.size() % checkpoint_interval == 0)
+        checkpoints_.push_back(totals_);
+
+    totals_.add(t.type, t.amount);
+}
+
+namespace Banking
+{
+    bool operator==(const Ledger& ledger, const vector<Transaction>& transactions)
+    {
+        return ledger.size() == transactions.size()
+            && equal(ledger.begin(), ledger.end(), transactions.begin());
+    }
+}
@@ -0,0 +1,326 @@
+#ifndef LEDGER_HPP
+#define LEDGER_HPP
+
+#include "transaction.hpp"
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace Banking
+{
+    enum class Timestamps
+    {
+        off, on
+    };
+
+    class ColdStorage;
+
+    // Columnar (struct-of-arrays) history of transactions - types, amounts
+    // and optional timestamps are stored in separate contiguous arrays.
+    // Aggregates are indexed incrementally: running totals per type and a checkpoint
+    // (totals of all preceding entries) every checkpoint_interval entries - range
+    // queries scan at most checkpoint_interval entries.
+    // Older entries may be compacted - folded into the compaction checkpoint and
+    // moved to a cold storage file (or dropped); positions are never renumbered.
+    class Ledger
+    {
+    public:
+        using Clock = std::chrono::system_clock;
+
+        static constexpr size_t checkpoint_interval = 64;
+
+        // sums & counts of transactions per type
+        class Totals
+        {
+        public:
+            Money amount(TransactionType type) const
+            {
+                return Money::from_units(amounts_[slot(type)]);
+            }
+
+            size_t count(TransactionType type) const
+            {
+                return counts_[slot(type)];
+            }
+
+            // deposits + interests - withdrawals
+            Money net() const
+            {
+                return Money::from_units(amounts_[slot(TransactionType::deposit)] + amounts_[slot(TransactionType::interest)]
+                                         - amounts_[slot(TransactionType::withdraw)]);
+            }
+
+            void add(TransactionType type, Money amount)
+            {
+                amounts_[slot(type)] += amount.units();
+                ++counts_[slot(type)];
+            }
+
+            friend Totals operator-(Totals left, const Totals& right)
+            {
+                for (size_t i = 0; i < left.amounts_.size(); ++i)
+                {
+                    left.amounts_[i] -= right.amounts_[i];
+                    left.counts_[i] -= right.counts_[i];
+                }
+
+                return left;
+            }
+
+        private:
+            static size_t slot(TransactionType type)
+            {
+                switch (type)
+                {
+                    case TransactionType::interest:
+                        return 0;
+                    case TransactionType::withdraw:
+                        return 1;
+                    default:
+                        return 2;
+                }
+            }
+
+            std::array<int64_t, 3> amounts_{};
+            std::array<size_t, 3> counts_{};
+        };
+
+        // entries are returned by value (compacted ones are read from the cold storage),
+        // so the iterator is only an input iterator
+        class const_iterator
+        {
+        public:
+            using iterator_category = std::input_iterator_tag;
+            using value_type = Transaction;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const Transaction*;
+            using reference = Transaction;
+
+            const_iterator(const Ledger* ledger, size_t index)
+                : ledger_{ledger}, index_{index}
+            {}
+
+            Transaction operator*() const
+            {
+                return (*ledger_)[index_];
+            }
+
+            const_iterator& operator++()
+            {
+                ++index_;
+                return *this;
+            }
+
+            const_iterator operator++(int)
+            {
+                const_iterator prev = *this;
+                ++index_;
+                return prev;
+            }
+
+            bool operator==(const const_iterator& other) const
+            {
+                return index_ == other.index_ && ledger_ == other.ledger_;
+            }
+
+            bool operator!=(const const_iterator& other) const
+            {
+                return !(*this == other);
+            }
+
+        private:
+            const Ledger* ledger_;
+            size_t index_;
+        };
+
+        explicit Ledger(Timestamps timestamps = Timestamps::off)
+            : with_timestamps_{timestamps == Timestamps::on}
+        {}
+
+        // timestamp (if enabled) is set to the current time
+        void append(const Transaction& t);
+
+        void append(const Transaction& t, Clock::time_point timestamp);
+
+        void reserve(size_t capacity);
+
+        // all entries - including compacted ones
+        size_t size() const
+        {
+            return compacted_ + amounts_.size();
+        }
+
+        bool empty() const
+        {
+            return size() == 0;
+        }
+
+        // number of compacted entries - resident entries start at this position
+        size_t compacted() const
+        {
+            return compacted_;
+        }
+
+        size_t resident() const
+        {
+            return amounts_.size();
+        }
+
+        // totals of compacted entries [0, compacted())
+        const Totals& compacted_totals() const
+        {
+            return compacted_totals_;
+        }
+
+        // entries [0, size() - keep_last) are folded into compacted_totals(); they are appended
+        // to the cold storage (read back lazily by operator[]) or dropped when cold is nullptr
+        void compact(size_t keep_last, std::shared_ptr<ColdStorage> cold = nullptr);
+
+        bool has_timestamps() const
+        {
+            return with_timestamps_;
+        }
+
+        // compacted entries are read from the cold storage -
+        // std::out_of_range when they were dropped
+        Transaction operator[](size_t index) const
+        {
+            if (index >= compacted_)
+                return Transaction{types_[index - compacted_], amounts_[index - compacted_]};
+
+            return read_compacted(index).first;
+        }
+
+        // std::logic_error when the ledger is kept without timestamps
+        Clock::time_point timestamp(size_t index) const
+        {
+            if (!with_timestamps_)
+                throw std::logic_error("Ledger: timestamps are off");
+
+            if (index >= compacted_)
+                return timestamps_[index - compacted_];
+
+            return read_compacted(index).second;
+        }
+
+        // columns of resident entries - positions [compacted(), size())
+        const std::vector<TransactionType>& types() const
+        {
+            return types_;
+        }
+
+        const std::vector<Money>& amounts() const
+        {
+            return amounts_;
+        }
+
+        const std::vector<Clock::time_point>& timestamps() const
+        {
+            return timestamps_;
+        }
+
+        const_iterator begin() const
+        {
+            return const_iterator{this, 0};
+        }
+
+        const_iterator end() const
+        {
+            return const_iterator{this, size()};
+        }
+
+        // O(1) - running totals
+        Money total(TransactionType type) const
+        {
+            return totals_.amount(type);
+        }
+
+        size_t count(TransactionType type) const
+        {
+            return totals_.count(type);
+        }
+
+        const Totals& totals() const
+        {
+            return totals_;
+        }
+
+        // totals of entries [0, position) - nearest checkpoint + scan of at most checkpoint_interval entries
+        // (compacted entries after the checkpoint are read from the cold storage)
+        Totals totals_before(size_t position) const;
+
+        // totals of entries [first, last)
+        Totals totals(size_t first, size_t last) const
+        {
+            return totals_before(last) - totals_before(first);
+        }
+
+        Money total(TransactionType type, size_t first, size_t last) const
+        {
+            return totals(first, last).amount(type);
+        }
+
+        size_t count(TransactionType type, size_t first, size_t last) const
+        {
+            return totals(first, last).count(type);
+        }
+
+    private:
+        std::vector<TransactionType> types_;
+        std::vector<Money> amounts_;
+        std::vector<Clock::time_point> timestamps_; // empty when timestamps are off
+        bool with_timestamps_;
+        Totals totals_;                   // all entries
+        std::vector<Totals> checkpoints_; // checkpoints_[i] - totals of entries [0, compacted_ + i * checkpoint_interval)
+
+        // compacted entries [position, position + count) stored in cold storage starting at record
+        struct ColdSegment
+        {
+            std::shared_ptr<const ColdStorage> storage;
+            size_t position;
+            size_t record;
+            size_t count;
+        };
+
+        size_t compacted_ = 0;
+        Totals compacted_totals_;
+        std::vector<Totals> cold_checkpoints_; // cold_checkpoints_[i] - totals of entries [0, i * checkpoint_interval)
+                                               // for i * checkpoint_interval < compacted_
+        std::vector<ColdSegment> cold_segments_; // ordered by position
+
+        void index(const Transaction& t);
+
+        // std::out_of_range when the entry was dropped
+        const ColdSegment& cold_segment(size_t index) const;
+
+        std::pair<Transaction, Clock::time_point> read_compacted(size_t index) const;
+
+        // compacted entries [first, last) are added to totals
+        void add_compacted(Totals& totals, size_t first, size_t last) const;
+    };
+
+    bool operator==(const Ledger& ledger, const std::vector<Transaction>& transactions);
+
+    inline bool operator==(const std::vector<Transaction>& transactions, const Ledger& ledger)
+    {
+        return ledger == transactions;
+    }
+
+    inline bool operator!=(const Ledger& ledger, const std::vector<Transaction>& transactions)
+    {
+        return !(ledger == transactions);
+    }
+
+    inline bool operator!=(const std::vector<Transaction>& transactions, const Ledger& ledger)
+    {
+        return !(ledger == transactions);
+    }
+}
+
+#endif // LEDGER_HPP
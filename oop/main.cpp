@@ -1,10 +1,24 @@
 #define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
 #include "catch.hpp"
+#include "account_store.hpp"
 #include "bank_account.hpp"
+#include "batch_processing.hpp"
+#include "cold_storage.hpp"
+#include "concurrent_bank_account.hpp"
+#include "formatting.hpp"
+#include "transaction_log.hpp"
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <fstream>
 #include <iostream>
 #include <string>
+#include <system_error>
 #include <vector>
 #include <sstream>
+#include <thread>
+#include <sys/resource.h>
 
 using namespace std::literals;
 using namespace Banking;
@@ -31,29 +45,29 @@ TEST_CASE("Date - struct with method")
 
 TEST_CASE("BankAccount - construction")
 {
-    BankAccount ba1{1, "Jan Kowalski", 100.0};
+    BankAccount ba1{1, "Jan Kowalski", Money{100.0}};
 
     REQUIRE(ba1.id() == 1);
     REQUIRE(ba1.owner() == "Jan Kowalski");
-    REQUIRE(ba1.balance() == Approx(100.0));
+    REQUIRE(ba1.balance() == Money{100.0});
 }
 
 TEST_CASE("BankAccount - deposit")
 {
-    BankAccount ba1{1, "Jan Kowalski", 100.0};
+    BankAccount ba1{1, "Jan Kowalski", Money{100.0}};
 
-    ba1.deposit(50.0);
+    ba1.deposit(Money{50.0});
 
-    REQUIRE(ba1.balance() == Approx(150.0));
+    REQUIRE(ba1.balance() == Money{150.0});
 }
 
 TEST_CASE("BankAccount - withdraw")
 {
-    BankAccount ba1{1, "Jan Kowalski", 100.0};
+    BankAccount ba1{1, "Jan Kowalski", Money{100.0}};
 
-    ba1.withdraw(50.0);
+    ba1.withdraw(Money{50.0});
 
-    REQUIRE(ba1.balance() == Approx(50.0));
+    REQUIRE(ba1.balance() == Money{50.0});
 
     Banking::print(ba1);
 }
@@ -62,54 +76,231 @@ TEST_CASE("BankAccount - interest rate")
 {
     //BankAccount::set_interest_rate(0.1);
 
-    BankAccount ba1{1, "Jan Kowalski", 100.0};
+    BankAccount ba1{1, "Jan Kowalski", Money{100.0}};
 
     ba1.set_interest_rate(0.1);
 
     ba1.pay_interest(365);
 
-    REQUIRE(ba1.balance() == Approx(110.0));
+    REQUIRE(ba1.balance() == Money{110.0});
 }
 
 TEST_CASE("BankAccount - transactions")
 {
     BankAccount::set_interest_rate(0.1);
-    BankAccount account {665, "Adam Nowak", 100.0};
+    BankAccount account {665, "Adam Nowak", Money{100.0}};
 
     REQUIRE(account.transactions().size() == 0);
 
     account.pay_interest(365);
-    account.withdraw(50.0);
-    account.deposit(100.0);
-    account.withdraw(1.0);
+    account.withdraw(Money{50.0});
+    account.deposit(Money{100.0});
+    account.withdraw(Money{1.0});
 
     std::vector<Transaction> expected_transactions = {
-        Transaction {TransactionType::interest, 10.0},
-        Transaction {TransactionType::withdraw, 50.0},
-        Transaction {TransactionType::deposit, 100.0},
-        Transaction {TransactionType::withdraw, 1.0}
+        Transaction {TransactionType::interest, Money{10.0}},
+        Transaction {TransactionType::withdraw, Money{50.0}},
+        Transaction {TransactionType::deposit, Money{100.0}},
+        Transaction {TransactionType::withdraw, Money{1.0}}
     };
 
     REQUIRE(account.transactions() == expected_transactions);
 }
 
+TEST_CASE("BankAccount - columnar ledger")
+{
+    BankAccount account {667, "Anna Nowak", Money{1'000.0}, Timestamps::on};
+
+    account.deposit(Money{100.0});
+    account.withdraw(Money{50.0});
+    account.withdraw(Money{25.0});
+
+    const Ledger& ledger = account.transactions();
+
+    REQUIRE(ledger.size() == 3);
+    REQUIRE(ledger[1] == Transaction{TransactionType::withdraw, Money{50.0}});
+    REQUIRE(ledger.total(TransactionType::withdraw) == Money{75.0});
+    REQUIRE(ledger.count(TransactionType::withdraw) == 2);
+    REQUIRE(ledger.total(TransactionType::interest) == Money{0.0});
+
+    REQUIRE(ledger.has_timestamps());
+    REQUIRE(ledger.timestamp(0) <= ledger.timestamp(2));
+
+    BankAccount without_timestamps{668, "Jan Nowak", Money{0.0}};
+    without_timestamps.deposit(Money{1.0});
+
+    REQUIRE_FALSE(without_timestamps.transactions().has_timestamps());
+    REQUIRE_THROWS_AS(without_timestamps.transactions().timestamp(0), std::logic_error);
+}
+
+TEST_CASE("BankAccount - ledger index")
+{
+    BankAccount::set_interest_rate(0.1);
+    BankAccount account{670, "Anna Kowalska", Money{1'000.0}};
+
+    for (int i = 1; i <= 200; ++i) // spans several checkpoints
+    {
+        account.deposit(Money{i * 1.0});
+        if (i % 10 == 0)
+            account.withdraw(Money{5.0});
+    }
+    account.pay_interest(365);
+
+    const Ledger& ledger = account.transactions();
+    REQUIRE(ledger.size() == 221);
+
+    SECTION("running totals")
+    {
+        REQUIRE(ledger.total(TransactionType::deposit) == Money{200 * 201 / 2});
+        REQUIRE(ledger.count(TransactionType::withdraw) == 20);
+        REQUIRE(ledger.totals().net() == account.balance() - Money{1'000.0});
+    }
+
+    SECTION("range queries match a scan")
+    {
+        for (size_t first : {0, 1, 63, 64, 65})
+            for (size_t last : {size_t{65}, size_t{128}, size_t{200}, ledger.size()})
+            {
+                Money deposits;
+                size_t withdrawals = 0;
+                for (size_t i = first; i < last; ++i)
+                {
+                    if (ledger[i].type == TransactionType::deposit)
+                        deposits += ledger[i].amount;
+                    withdrawals += ledger[i].type == TransactionType::withdraw;
+                }
+
+                REQUIRE(ledger.total(TransactionType::deposit, first, last) == deposits);
+                REQUIRE(ledger.count(TransactionType::withdraw, first, last) == withdrawals);
+            }
+    }
+
+    SECTION("balance at position")
+    {
+        REQUIRE(account.balance_at(0) == Money{1'000.0});
+        REQUIRE(account.balance_at(2) == Money{1'003.0});
+        REQUIRE(account.balance_at(11) == Money{1'000.0 + 55 - 5});
+        REQUIRE(account.balance_at(ledger.size()) == account.balance());
+    }
+}
+
+TEST_CASE("BankAccount - history compaction")
+{
+    const std::string path = "cold_transactions.dat";
+
+    BankAccount account{671, "Jan Kowalski", Money{100.0}, Timestamps::on};
+    std::vector<Transaction> history;
+
+    for (int i = 1; i <= 300; ++i)
+    {
+        account.deposit(Money{i * 0.01});
+        history.push_back(Transaction{TransactionType::deposit, Money{i * 0.01}});
+    }
+    account.withdraw(Money{50.0});
+    history.push_back(Transaction{TransactionType::withdraw, Money{50.0}});
+
+    const Money balance_before = account.balance_at(150);
+
+    SECTION("moved to cold storage")
+    {
+        auto cold = std::make_shared<ColdStorage>(path);
+
+        account.compact_history(100, cold);
+        account.compact_history(50, cold); // appended to the same file
+
+        const Ledger& ledger = account.transactions();
+        REQUIRE(ledger.size() == 301);
+        REQUIRE(ledger.resident() == 50);
+        REQUIRE(ledger.compacted() == 251);
+        REQUIRE(cold->size() == 251);
+
+        Checkpoint checkpoint = account.checkpoint();
+        REQUIRE(checkpoint.position == 251);
+        REQUIRE(checkpoint.balance == account.balance() - Money{(252 + 300) * 49 / 2 * 0.01 - 50.0});
+        REQUIRE(checkpoint.totals.count(TransactionType::deposit) == 251);
+
+        REQUIRE(ledger == history); // cold & resident entries stitched together
+        REQUIRE(ledger.timestamp(0) <= ledger.timestamp(300));
+        REQUIRE(account.balance_at(150) == balance_before);
+        REQUIRE(ledger.total(TransactionType::deposit, 10, 290) == Money{(11 + 290) * 280 / 2 * 0.01});
+    }
+
+    SECTION("dropped")
+    {
+        account.compact_history(20);
+
+        const Ledger& ledger = account.transactions();
+        REQUIRE(ledger.resident() == 20);
+        REQUIRE(ledger[300] == history[300]);
+        REQUIRE_THROWS_AS(ledger[0], std::out_of_range);
+        // dropped entries between checkpoints are not needed
+        REQUIRE(ledger.total(TransactionType::deposit, 64, 192) == Money::from_units((65 + 192) * 128 / 2));
+        REQUIRE_THROWS_AS(ledger.total(TransactionType::deposit, 10, 192), std::out_of_range);
+        REQUIRE(ledger.total(TransactionType::deposit) == Money{300 * 301 / 2 * 0.01});
+        REQUIRE(account.checkpoint().balance == account.balance_at(281));
+    }
+
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Money - fixed-point amounts")
+{
+    Money sum;
+    for (int i = 0; i < 10; ++i)
+        sum += Money{0.1};
+
+    REQUIRE(sum == Money{1.0}); // exact - no accumulated rounding errors
+    REQUIRE(Money{10.005}.units() == 1'001);
+    REQUIRE(Money::from_double(0.125, Rounding::half_even).units() == 12);
+    REQUIRE(Money::from_double(0.135, Rounding::half_even).units() == 14);
+    REQUIRE(Money::from_double(-0.129, Rounding::toward_zero).units() == -12);
+
+    std::stringstream out;
+    out << Money{100.0} << " " << Money{10.5} << " " << Money{-0.07};
+    REQUIRE(out.str() == "100 10.5 -0.07");
+
+    SECTION("overflow is reported & the amount is left unchanged")
+    {
+        Money max = Money::from_units(INT64_MAX);
+        Money min = Money::from_units(INT64_MIN);
+
+        REQUIRE_THROWS_AS(max += Money{0.01}, std::overflow_error);
+        REQUIRE_THROWS_AS(min -= Money{0.01}, std::overflow_error);
+        REQUIRE_THROWS_AS(-min, std::overflow_error);
+        REQUIRE(max.units() == INT64_MAX);
+        REQUIRE(min.units() == INT64_MIN);
+        REQUIRE((max - Money{0.01}).units() == INT64_MAX - 1);
+    }
+
+    SECTION("interest is rounded to the minor unit")
+    {
+        BankAccount::set_interest_rate(0.035);
+        BankAccount account{669, "Jan Nowak", Money{1'000.01}};
+
+        account.pay_interest(31); // 2.972632...
+
+        REQUIRE(account.transactions()[0].amount == Money{2.97});
+        REQUIRE(account.balance() == Money{1'002.98});
+    }
+}
+
 TEST_CASE("operator== for transactions")
 {
     int x = 4;
     int y = 4;
     REQUIRE(x == y);
 
-    Transaction t1{TransactionType::interest, 1.0};
-    Transaction t2{TransactionType::interest, 1.0};
+    Transaction t1{TransactionType::interest, Money{1.0}};
+    Transaction t2{TransactionType::interest, Money{1.0}};
     REQUIRE(t1 == t2);
 
-    Transaction t3{TransactionType::deposit, 1.0};
+    Transaction t3{TransactionType::deposit, Money{1.0}};
     REQUIRE(t1 != t3);
 }
 
 TEST_CASE("operator << for transactions")
 {
-    Transaction t{TransactionType::deposit, 100.0};
+    Transaction t{TransactionType::deposit, Money{100.0}};
 
     std::cout << t << "\n";
 }
@@ -117,7 +308,7 @@ TEST_CASE("operator << for transactions")
 
 TEST_CASE("operator << for BankAccount")
 {
-    BankAccount account{665, "Jan Nowak", 100.0};
+    BankAccount account{665, "Jan Nowak", Money{100.0}};
 
     std::stringstream ss;
     ss << account;
@@ -125,9 +316,446 @@ TEST_CASE("operator << for BankAccount")
     REQUIRE(ss.str() == "BankAccount{id: 665, owner: Jan Nowak, balance: 100}");
 }
 
+TEST_CASE("formatting into buffers")
+{
+    BankAccount::set_interest_rate(0.1);
+    BankAccount account{665, "Jan Nowak", Money{100.0}};
+    account.deposit(Money{0.5});
+    account.withdraw(Money{0.05});
+    account.pay_interest(365);
+
+    std::stringstream expected;
+    print_statement(expected, account);
+
+    char buffer[256];
+
+    SECTION("the same text as operator<<")
+    {
+        std::stringstream out;
+        out << account;
+
+        auto result = to_chars(std::begin(buffer), std::end(buffer), account);
+        REQUIRE(result.ec == std::errc{});
+        REQUIRE(std::string_view(buffer, result.ptr - buffer) == out.str());
+
+        result = format_statement(std::begin(buffer), std::end(buffer), account);
+        REQUIRE(result.ec == std::errc{});
+        REQUIRE(std::string_view(buffer, result.ptr - buffer) == expected.str());
+    }
+
+    SECTION("buffer too small")
+    {
+        auto result = to_chars(buffer, buffer + 20, account);
+        REQUIRE(result.ec == std::errc::value_too_large);
+
+        result = to_chars(buffer, buffer + 2, Money{-0.07});
+        REQUIRE(result.ec == std::errc::value_too_large);
+    }
+
+    SECTION("bulk export")
+    {
+        std::vector<BankAccount> accounts(3'000, account);
+
+        std::stringstream out;
+        write_statements(out, accounts);
+
+        std::string all_expected;
+        for (size_t i = 0; i < accounts.size(); ++i)
+            all_expected += expected.str();
+
+        REQUIRE(out.str() == all_expected); // crosses boundaries of the internal buffer
+    }
+}
+
+TEST_CASE("formatting - statement export benchmark", "[.][benchmark]")
+{
+    std::vector<BankAccount> accounts;
+    accounts.reserve(100'000);
+    for (int id = 1; id <= 100'000; ++id)
+    {
+        accounts.emplace_back(id, "Owner " + std::to_string(id), Money{id * 1.25});
+        accounts.back().deposit(Money{10.5});
+        accounts.back().withdraw(Money{0.99});
+    }
+
+    std::ofstream out{"/dev/null"};
+
+    BENCHMARK("operator<< - stream")
+    {
+        for (const auto& account : accounts)
+            print_statement(out, account);
+    };
+
+    BENCHMARK("write_statements - to_chars")
+    {
+        write_statements(out, accounts);
+    };
+}
+
 TEST_CASE("withdraw too much")
 {
-    BankAccount account{666, "Lars", 1'000'000.0};
+    BankAccount account{666, "Lars", Money{1'000'000.0}};
+
+    REQUIRE_THROWS_AS(account.withdraw(Money{2'000'000.0}), InsufficientFundsError);
+}
+
+
+TEST_CASE("ConcurrentBankAccount")
+{
+    ConcurrentBankAccount account{700, "Hot Account", Money{1'000.0}};
+
+    const int no_of_threads = 4;
+    const int no_of_operations = 10'000;
+
+    SECTION("concurrent deposits")
+    {
+        std::vector<std::thread> threads;
+        for (int i = 0; i < no_of_threads; ++i)
+            threads.emplace_back([&account] {
+                for (int j = 0; j < no_of_operations; ++j)
+                    account.deposit(Money{1.0});
+            });
+
+        for (auto& thd : threads)
+            thd.join();
+
+        REQUIRE(account.balance() == Money{1'000.0 + no_of_threads * no_of_operations});
+
+        Ledger transactions = account.transactions();
+        REQUIRE(transactions.size() == no_of_threads * no_of_operations);
+        REQUIRE(transactions.total(TransactionType::deposit) == Money{1.0 * no_of_threads * no_of_operations});
+    }
+
+    SECTION("concurrent withdrawals never overdraw")
+    {
+        std::atomic<int> failures{0};
+
+        std::vector<std::thread> threads;
+        for (int i = 0; i < no_of_threads; ++i)
+            threads.emplace_back([&account, &failures] {
+                for (int j = 0; j < 500; ++j)
+                {
+                    try
+                    {
+                        account.withdraw(Money{1.0});
+                    }
+                    catch (const InsufficientFundsError&)
+                    {
+                        ++failures;
+                    }
+                }
+            });
+
+        for (auto& thd : threads)
+            thd.join();
+
+        REQUIRE(account.balance() == Money{0.0});
+        REQUIRE(failures == no_of_threads * 500 - 1'000);
+        REQUIRE(account.transactions().count(TransactionType::withdraw) == 1'000);
+    }
+
+    SECTION("interest")
+    {
+        BankAccount::set_interest_rate(0.1);
+
+        account.pay_interest(365);
+
+        REQUIRE(account.balance() == Money{1'100.0});
+        REQUIRE(account.transactions() == std::vector<Transaction>{{TransactionType::interest, Money{100.0}}});
+    }
+}
+
+TEST_CASE("batch processing")
+{
+    std::vector<BankAccount> accounts;
+    for (int id = 1; id <= 8; ++id)
+        accounts.emplace_back(id, "Owner " + std::to_string(id), Money{100.0});
+
+    std::vector<Operation> operations;
+    for (int i = 0; i < 1'000; ++i)
+        operations.push_back(Operation{i % 8 + 1, TransactionType::deposit, Money{1.0}});
+
+    operations.push_back(Operation{3, TransactionType::withdraw, Money{1'000.0}}); // 225 available
+    operations.push_back(Operation{3, TransactionType::withdraw, Money{25.0}});
+    operations.push_back(Operation{5, TransactionType::withdraw, Money{500.0}});
+
+    BatchResult result = process_batch(operations, accounts, 4);
+
+    REQUIRE(result.applied == 1'001);
+    REQUIRE(result.failures.size() == 2);
+    REQUIRE(result.failures[0].operation_index == 1'000);
+    REQUIRE(result.failures[0].error.account_id == 3);
+    REQUIRE(result.failures[0].error.account_balance == Money{225.0});
+    REQUIRE(result.failures[1].operation_index == 1'002);
+
+    REQUIRE(accounts[2].balance() == Money{200.0});
+    REQUIRE(accounts[4].balance() == Money{225.0});
+    REQUIRE(accounts[2].transactions().size() == 126);
+
+    SECTION("unknown account")
+    {
+        std::vector<Operation> invalid = {{1, TransactionType::deposit, Money{1.0}}, {665, TransactionType::deposit, Money{1.0}}};
+
+        REQUIRE_THROWS_AS(process_batch(invalid, accounts), std::invalid_argument);
+        REQUIRE(accounts[0].balance() == Money{225.0});
+    }
+}
+
+TEST_CASE("AccountStore")
+{
+    AccountStore store{8};
+
+    std::vector<BankAccount> accounts;
+    for (int id = 1; id <= 10'000; ++id)
+        accounts.emplace_back(id, "Owner " + std::to_string(id), Money{1.0 * id});
+
+    store.bulk_load(std::move(accounts));
+    store.insert(BankAccount{20'000, "Jan Kowalski", Money{100.0}});
+
+    REQUIRE(store.size() == 10'001);
+
+    SECTION("lookup by id")
+    {
+        REQUIRE(store.find(5'000)->balance() == Money{5'000.0});
+        REQUIRE(store.find(20'000)->owner() == "Jan Kowalski");
+        REQUIRE(store.find(10'001) == nullptr);
+        REQUIRE(store.contains(1));
+    }
+
+    SECTION("duplicated id")
+    {
+        REQUIRE_THROWS_AS(store.insert(BankAccount{1, "Clone", Money{0.0}}), std::invalid_argument);
+    }
+
+    SECTION("concurrent updates")
+    {
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t)
+            threads.emplace_back([&store] {
+                for (int id = 1; id <= 1'000; ++id)
+                    store.update(id, [](BankAccount& account) { account.deposit(Money{1.0}); });
+            });
+
+        for (auto& thd : threads)
+            thd.join();
+
+        REQUIRE(store.find(1)->balance() == Money{5.0});
+        REQUIRE(store.find(1'000)->transactions().size() == 4);
+    }
+
+    SECTION("iteration & snapshot")
+    {
+        Money total;
+        store.for_each([&total](const BankAccount& account) { total += account.balance(); });
+        REQUIRE(total == Money{10'000 * 10'001 / 2 + 100.0});
+
+        std::vector<BankAccount> snapshot = store.snapshot();
+        store.update(20'000, [](BankAccount& account) { account.withdraw(Money{100.0}); });
+
+        auto it = std::find_if(snapshot.begin(), snapshot.end(), [](const auto& a) { return a.id() == 20'000; });
+        REQUIRE(snapshot.size() == 10'001);
+        REQUIRE(it->balance() == Money{100.0});
+    }
+
+    SECTION("bulk interest")
+    {
+        BankAccount::set_interest_rate(0.035);
+        store.update(1, [](BankAccount& account) { account.deposit(Money{1'000.0}); }); // column of balances follows
+
+        std::vector<BankAccount> expected = store.snapshot();
+        for (auto& account : expected)
+            account.pay_interest(31);
+
+        store.pay_interest(31, 4);
+
+        size_t mismatches = 0;
+        for (const auto& account : expected)
+        {
+            const BankAccount* paid = store.find(account.id());
+
+            if (paid->balance() != account.balance() // exactly the same
+                || paid->transactions()[0] != account.transactions()[0])
+                ++mismatches;
+        }
+
+        REQUIRE(mismatches == 0);
+    }
+
+    SECTION("batch processing")
+    {
+        std::vector<Operation> operations = {
+            {1, TransactionType::deposit, Money{10.0}},
+            {2, TransactionType::withdraw, Money{3.0}},
+            {3, TransactionType::withdraw, Money{2.0}}
+        };
+
+        BatchResult result = process_batch(operations, store, 4);
+
+        REQUIRE(result.applied == 2);
+        REQUIRE(result.failures.size() == 1);
+        REQUIRE(result.failures[0].operation_index == 1);
+        REQUIRE(store.find(1)->balance() == Money{11.0});
+    }
+}
+
+TEST_CASE("transaction log - group commit & recovery")
+{
+    const std::string path = "transactions.wal";
+    std::remove(path.c_str());
+
+    BankAccount::set_interest_rate(0.05);
+
+    std::vector<BankAccount> accounts;
+    for (int id = 1; id <= 100; ++id)
+        accounts.emplace_back(id, "Owner " + std::to_string(id), Money{100.0});
+
+    {
+        TransactionLogWriter log{path, GroupCommit{64, std::chrono::milliseconds{5}}};
+
+        for (int round = 0; round < 10; ++round)
+            for (auto& account : accounts)
+            {
+                account.deposit(Money{10.0});
+                log.append(account.id(), account.transactions()[account.transactions().size() - 1]);
+
+                account.withdraw(Money{round + 1.0});
+                log.append(account.id(), account.transactions()[account.transactions().size() - 1]);
+            }
+
+        for (auto& account : accounts)
+        {
+            account.pay_interest(30);
+            log.append(account.id(), account.transactions()[account.transactions().size() - 1]);
+        }
+
+        log.commit();
+        REQUIRE(log.committed() == 2'100);
+    } // log is closed
+
+    REQUIRE(TransactionLogReader{path}.size() == 2'100);
+
+    AccountStore store{8};
+    for (int id = 1; id <= 100; ++id)
+        store.insert(BankAccount{id, "Owner " + std::to_string(id), Money{100.0}});
+
+    REQUIRE(recover(store, path, 4) == 2'100);
+
+    for (const auto& account : accounts)
+    {
+        REQUIRE(store.find(account.id())->balance() == account.balance());
+        REQUIRE(store.find(account.id())->transactions().size() == 21);
+    }
+
+    SECTION("full batch is committed by the flusher")
+    {
+        TransactionLogWriter log{path, GroupCommit{16, std::chrono::hours{1}}};
+
+        for (int i = 0; i < 16; ++i)
+            log.append(1, Transaction{TransactionType::deposit, Money{1.0}});
+
+        while (log.committed() < 16)
+            std::this_thread::yield();
+
+        REQUIRE(TransactionLogReader{path}.size() == 2'116);
+    }
+
+    SECTION("synced append returns when the record is committed")
+    {
+        TransactionLogWriter log{path, GroupCommit{1'000, std::chrono::hours{1}}};
+
+        log.append(1, Transaction{TransactionType::deposit, Money{1.0}});
+        log.append(1, Transaction{TransactionType::deposit, Money{2.0}}, Durability::synced);
+
+        REQUIRE(log.committed() == 2);
+        REQUIRE(TransactionLogReader{path}.size() == 2'102);
+    }
+
+    SECTION("appending to existing log")
+    {
+        {
+            TransactionLogWriter log{path};
+            log.append(1, Transaction{TransactionType::deposit, Money{1.0}});
+        } // pending records are committed by destructor
+
+        REQUIRE(TransactionLogReader{path}.size() == 2'101);
+    }
+
+    std::remove(path.c_str());
+}
+
+// limits size of files written by the process (SIGXFSZ is ignored - write fails with EFBIG);
+// previous limit & signal handler are restored by the destructor
+class ScopedFileSizeLimit
+{
+    rlimit original_limit_;
+    void (*original_handler_)(int);
+public:
+    explicit ScopedFileSizeLimit(rlim_t max_size)
+    {
+        if (getrlimit(RLIMIT_FSIZE, &original_limit_) != 0)
+            throw std::system_error(errno, std::generic_category(), "getrlimit");
+
+        original_handler_ = std::signal(SIGXFSZ, SIG_IGN);
+
+        rlimit limit = original_limit_;
+        limit.rlim_cur = max_size;
+        if (setrlimit(RLIMIT_FSIZE, &limit) != 0)
+        {
+            std::signal(SIGXFSZ, original_handler_);
+            throw std::system_error(errno, std::generic_category(), "setrlimit");
+        }
+    }
+
+    ScopedFileSizeLimit(const ScopedFileSizeLimit&) = delete;
+    ScopedFileSizeLimit& operator=(const ScopedFileSizeLimit&) = delete;
+
+    ~ScopedFileSizeLimit()
+    {
+        setrlimit(RLIMIT_FSIZE, &original_limit_);
+        std::signal(SIGXFSZ, original_handler_);
+    }
+};
+
+TEST_CASE("transaction log - failed commit is retried without duplicates")
+{
+    const std::string path = "failed_commit.wal";
+    std::remove(path.c_str());
+
+    const Money amounts[] = {Money::from_units(100'00), Money::from_units(20'00),
+                             Money::from_units(3'00), Money::from_units(4)};
+
+    {
+        TransactionLogWriter log{path, GroupCommit{1'000, std::chrono::hours{1}}}; // commits only on request
+
+        log.append(1, Transaction{TransactionType::deposit, amounts[0]});
+        log.commit();
+
+        for (int i = 1; i < 4; ++i)
+            log.append(1, Transaction{TransactionType::deposit, amounts[i]});
+
+        {
+            // file size limit lets only a part of the batch in - write fails in the middle of a record
+            ScopedFileSizeLimit limit{sizeof(LogHeader) + 2 * sizeof(LogRecord) + sizeof(LogRecord) / 2};
+
+            REQUIRE_THROWS_AS(log.commit(), std::system_error);
+        }
+
+        REQUIRE(log.committed() == 1);
+        REQUIRE(TransactionLogReader{path}.size() == 1); // partially written batch is cut off
+
+        log.commit(); // retry
+        REQUIRE(log.committed() == 4);
+    }
+
+    TransactionLogReader reader{path};
+    REQUIRE(reader.size() == 4);
+    for (int i = 0; i < 4; ++i)
+        REQUIRE(reader[i].amount == amounts[i].units());
+
+    AccountStore store{2};
+    store.insert(BankAccount{1, "Owner", Money::from_units(0)});
+    REQUIRE(recover(store, path, 1) == 4);
+    REQUIRE(store.find(1)->balance() == Money::from_units(123'04)); // every record applied once
 
-    REQUIRE_THROWS_AS(account.withdraw(2'000'000), InsufficientFundsError);
+    std::remove(path.c_str());
 }
@@ -0,0 +1,185 @@
+#ifndef MONEY_HPP
+#define MONEY_HPP
+
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <stdexcept>
+#include <system_error>
+
+namespace Banking
+{
+    enum class Rounding
+    {
+        half_even,          // banker's rounding
+        half_away_from_zero,
+        toward_zero
+    };
+
+    // Fixed-point decimal amount - 64-bit integer number of minor units (1/100).
+    // Addition & subtraction are exact (std::overflow_error is thrown when the result is out of range);
+    // conversion from double rounds to the nearest minor unit.
+    class Money
+    {
+    public:
+        static constexpr int64_t scale = 100;
+        static constexpr size_t max_chars = 21; // -92233720368547758.08
+
+        constexpr Money() = default;
+
+        // amounts given as double (e.g. Money{100.0}) are rounded half away from zero
+        explicit Money(double amount)
+            : units_{static_cast<int64_t>(std::round(amount * scale))}
+        {}
+
+        static constexpr Money from_units(int64_t units)
+        {
+            return Money{units, 0};
+        }
+
+        // explicit rounding - e.g. for interest
+        static Money from_double(double amount, Rounding rounding)
+        {
+            const double scaled = amount * scale;
+
+            switch (rounding)
+            {
+                case Rounding::half_even:
+                    return from_units(static_cast<int64_t>(std::nearbyint(scaled))); // default FE_TONEAREST mode
+                case Rounding::toward_zero:
+                    return from_units(static_cast<int64_t>(std::trunc(scaled)));
+                default:
+                    return from_units(static_cast<int64_t>(std::round(scaled)));
+            }
+        }
+
+        constexpr int64_t units() const
+        {
+            return units_;
+        }
+
+        double to_double() const
+        {
+            return static_cast<double>(units_) / scale;
+        }
+
+        explicit operator double() const
+        {
+            return to_double();
+        }
+
+        Money& operator+=(Money other)
+        {
+            int64_t result;
+            if (__builtin_add_overflow(units_, other.units_, &result))
+                throw std::overflow_error("Money: overflow in addition");
+            units_ = result;
+            return *this;
+        }
+
+        Money& operator-=(Money other)
+        {
+            int64_t result;
+            if (__builtin_sub_overflow(units_, other.units_, &result))
+                throw std::overflow_error("Money: overflow in subtraction");
+            units_ = result;
+            return *this;
+        }
+
+        friend Money operator+(Money left, Money right)
+        {
+            return left += right;
+        }
+
+        friend Money operator-(Money left, Money right)
+        {
+            return left -= right;
+        }
+
+        friend Money operator-(Money amount)
+        {
+            return Money{} -= amount;
+        }
+
+        friend bool operator==(Money left, Money right)
+        {
+            return left.units_ == right.units_;
+        }
+
+        friend bool operator!=(Money left, Money right)
+        {
+            return left.units_ != right.units_;
+        }
+
+        friend bool operator<(Money left, Money right)
+        {
+            return left.units_ < right.units_;
+        }
+
+        friend bool operator<=(Money left, Money right)
+        {
+            return left.units_ <= right.units_;
+        }
+
+        friend bool operator>(Money left, Money right)
+        {
+            return left.units_ > right.units_;
+        }
+
+        friend bool operator>=(Money left, Money right)
+        {
+            return left.units_ >= right.units_;
+        }
+
+    private:
+        constexpr Money(int64_t units, int)
+            : units_{units}
+        {}
+
+        int64_t units_ = 0;
+    };
+
+    // the same text as for double amounts: 100, 10.5, 0.25 - at most Money::max_chars characters;
+    // {last, errc::value_too_large} when the buffer is too small (like std::to_chars)
+    inline std::to_chars_result to_chars(char* first, char* last, Money amount)
+    {
+        const int64_t units = amount.units();
+        const uint64_t abs_units = units < 0 ? 0 - static_cast<uint64_t>(units) : static_cast<uint64_t>(units);
+        const uint64_t fraction = abs_units % Money::scale;
+
+        if (units < 0)
+        {
+            if (first == last)
+                return {last, std::errc::value_too_large};
+            *first++ = '-';
+        }
+
+        std::to_chars_result result = std::to_chars(first, last, abs_units / Money::scale);
+        if (result.ec != std::errc{} || fraction == 0)
+            return result;
+
+        const bool two_digits = fraction % 10 != 0;
+        char* pos = result.ptr;
+        if (last - pos < (two_digits ? 3 : 2))
+            return {last, std::errc::value_too_large};
+
+        *pos++ = '.';
+        *pos++ = static_cast<char>('0' + fraction / 10);
+        if (two_digits)
+            *pos++ = static_cast<char>('0' + fraction % 10);
+
+        return {pos, std::errc{}};
+    }
+
+    inline std::ostream& operator<<(std::ostream& out, Money amount)
+    {
+        char buffer[24];
+        const std::to_chars_result result = to_chars(buffer, buffer + sizeof(buffer), amount);
+
+        return out.write(buffer, result.ptr - buffer);
+    }
+}
+
+#endif // MONEY_HPP
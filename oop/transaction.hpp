@@ -0,0 +1,37 @@
+#ifndef TRANSACTION_HPP
+#define TRANSACTION_HPP
+
+#include "money.hpp"
+#include <ostream>
+
+namespace Banking
+{
+    enum class TransactionType : char
+    {
+        interest = 'I', withdraw = 'W', deposit = 'D'
+    };
+
+    struct Transaction
+    {
+        TransactionType type;
+        Money amount;
+    };
+
+    inline bool operator==(const Transaction& left, const Transaction& right)
+    {
+        return left.type == right.type && left.amount == right.amount;
+    }
+
+    inline bool operator!=(const Transaction& left, const Transaction& right)
+    {
+        return !(left == right);
+    }
+
+    inline std::ostream& operator<<(std::ostream& stream_out, const Transaction& t)
+    {
+        stream_out << "Transaction{type: " << static_cast<char>(t.type) << ", amount: " << t.amount << "}";
+        return stream_out;
+    }
+}
+
+#endif // TRANSACTION_HPP
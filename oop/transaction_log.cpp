@@ -0,0 +1,287 @@
+#include "transaction_log.hpp"
+#include "account_store.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+using namespace Banking;
+
+namespace
+{
+    constexpr char log_magic[4] = {'B', 'W', 'A', 'L'};
+    constexpr uint32_t log_version = 2; // 2 - amounts in minor units
+
+    [[noreturn]] void throw_system_error(const string& what)
+    {
+        throw system_error(errno, generic_category(), what);
+    }
+
+    void write_all(int fd, const void* data, size_t size)
+    {
+        const char* ptr = static_cast<const char*>(data);
+
+        while (size > 0)
+        {
+            ssize_t written = ::write(fd, ptr, size);
+            if (written == -1)
+            {
+                if (errno == EINTR)
+                    continue;
+                throw_system_error("write");
+            }
+
+            ptr += written;
+            size -= static_cast<size_t>(written);
+        }
+    }
+
+    bool is_valid(const LogHeader& header)
+    {
+        return memcmp(header.magic, log_magic, sizeof(log_magic)) == 0 && header.version == log_version;
+    }
+}
+
+TransactionLogWriter::TransactionLogWriter(const string& path, GroupCommit group_commit)
+    : group_commit_{group_commit}
+{
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+    if (fd_ == -1)
+        throw_system_error("open: " + path);
+
+    try
+    {
+        struct stat file_stat;
+        if (::fstat(fd_, &file_stat) == -1)
+            throw_system_error("fstat: " + path);
+
+        if (file_stat.st_size == 0)
+        {
+            LogHeader header{};
+            memcpy(header.magic, log_magic, sizeof(log_magic));
+            header.version = log_version;
+
+            write_all(fd_, &header, sizeof(header));
+            if (::fdatasync(fd_) == -1)
+                throw_system_error("fdatasync: " + path);
+        }
+        else
+        {
+            LogHeader header{};
+            if (::pread(fd_, &header, sizeof(header), 0) != sizeof(header) || !is_valid(header))
+                throw runtime_error("Not a transaction log: " + path);
+
+            // torn record at the end of the file is cut off - new records stay aligned
+            const off_t valid_size = sizeof(LogHeader)
+                + (file_stat.st_size - sizeof(LogHeader)) / sizeof(LogRecord) * sizeof(LogRecord);
+            if (valid_size != file_stat.st_size && ::ftruncate(fd_, valid_size) == -1)
+                throw_system_error("ftruncate: " + path);
+        }
+
+        committed_size_ = ::lseek(fd_, 0, SEEK_END);
+        if (committed_size_ == -1)
+            throw_system_error("lseek: " + path);
+    }
+    catch (...)
+    {
+        ::close(fd_);
+        throw;
+    }
+
+    pending_.reserve(group_commit_.max_pending_records);
+    flusher_ = thread{[this] { run_flusher(); }};
+}
+
+TransactionLogWriter::~TransactionLogWriter()
+{
+    {
+        lock_guard<mutex> lk{mtx_pending_};
+        done_ = true;
+    }
+    cv_pending_.notify_one();
+    flusher_.join();
+
+    try
+    {
+        commit();
+    }
+    catch (...)
+    {
+        // Logging exception
+    }
+
+    ::close(fd_);
+}
+
+void TransactionLogWriter::append(int account_id, const Transaction& t, Durability durability)
+{
+    unique_lock<mutex> lk{mtx_pending_};
+
+    pending_.push_back(LogRecord{account_id, t.type, {}, t.amount.units()});
+    const uint64_t sequence_number = ++appended_;
+
+    // full batch is handed over to the flusher - appending threads are not blocked by write & sync
+    if (pending_.size() == 1 || pending_.size() == group_commit_.max_pending_records)
+        cv_pending_.notify_one();
+
+    if (durability == Durability::deferred)
+        return;
+
+    sync_requested_ = true;
+    cv_pending_.notify_one();
+
+    const uint64_t failed_commits = failed_commits_;
+    cv_committed_.wait(lk, [&] { return committed() >= sequence_number || failed_commits_ != failed_commits; });
+
+    if (committed() < sequence_number)
+        rethrow_exception(last_error_);
+}
+
+void TransactionLogWriter::commit()
+{
+    lock_guard<mutex> lk_io{mtx_io_};
+
+    if (failed_)
+        throw runtime_error("Transaction log cannot be written after a failed commit");
+
+    vector<LogRecord> batch;
+    batch.reserve(group_commit_.max_pending_records);
+
+    {
+        lock_guard<mutex> lk{mtx_pending_};
+        batch.swap(pending_);
+    }
+
+    if (batch.empty())
+        return;
+
+    const size_t batch_size = batch.size() * sizeof(LogRecord);
+
+    // appending threads are not blocked by write & sync
+    try
+    {
+        write_all(fd_, batch.data(), batch_size);
+        if (::fdatasync(fd_) == -1)
+            throw_system_error("fdatasync");
+    }
+    catch (...)
+    {
+        // part of the batch (or all of it when sync failed) may be in the file - it is cut off,
+        // so the retried batch is neither misaligned nor written twice
+        if (::ftruncate(fd_, committed_size_) == -1)
+            failed_ = true;
+
+        // batch is retried by the next commit
+        {
+            lock_guard<mutex> lk{mtx_pending_};
+            pending_.insert(pending_.begin(), batch.begin(), batch.end());
+            ++failed_commits_;
+            last_error_ = current_exception();
+        }
+        cv_committed_.notify_all();
+        throw;
+    }
+
+    committed_size_ += static_cast<off_t>(batch_size);
+
+    {
+        lock_guard<mutex> lk{mtx_pending_}; // synced appends cannot miss the notification
+        committed_.fetch_add(batch.size(), memory_order_release);
+    }
+    cv_committed_.notify_all();
+}
+
+void TransactionLogWriter::run_flusher()
+{
+    unique_lock<mutex> lk{mtx_pending_};
+
+    auto batch_is_due = [this] {
+        return done_ || sync_requested_ || pending_.size() >= group_commit_.max_pending_records;
+    };
+
+    while (!done_)
+    {
+        cv_pending_.wait(lk, [this] { return done_ || !pending_.empty(); });
+
+        if (done_)
+            break;
+
+        cv_pending_.wait_for(lk, group_commit_.max_delay, batch_is_due);
+
+        if (done_)
+            break;
+
+        sync_requested_ = false;
+        lk.unlock();
+        try
+        {
+            commit();
+        }
+        catch (...)
+        {
+            // records stay pending - retried after max_delay
+            lk.lock();
+            cv_pending_.wait_for(lk, group_commit_.max_delay, [this] { return done_; });
+            continue;
+        }
+        lk.lock();
+    }
+}
+
+TransactionLogReader::TransactionLogReader(const string& path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd == -1)
+        throw_system_error("open: " + path);
+
+    struct stat file_stat;
+    if (::fstat(fd, &file_stat) == -1)
+    {
+        const int error = errno;
+        ::close(fd);
+        throw system_error(error, generic_category(), "fstat: " + path);
+    }
+
+    mapping_size_ = static_cast<size_t>(file_stat.st_size);
+    if (mapping_size_ < sizeof(LogHeader))
+    {
+        ::close(fd);
+        throw runtime_error("Not a transaction log: " + path);
+    }
+
+    mapping_ = ::mmap(nullptr, mapping_size_, PROT_READ, MAP_SHARED, fd, 0);
+    const int error = errno;
+    ::close(fd);
+
+    if (mapping_ == MAP_FAILED)
+        throw system_error(error, generic_category(), "mmap: " + path);
+
+    if (!is_valid(*static_cast<const LogHeader*>(mapping_)))
+    {
+        ::munmap(mapping_, mapping_size_);
+        throw runtime_error("Not a transaction log: " + path);
+    }
+
+    ::madvise(mapping_, mapping_size_, MADV_SEQUENTIAL);
+
+    records_ = reinterpret_cast<const LogRecord*>(static_cast<const char*>(mapping_) + sizeof(LogHeader));
+    size_ = (mapping_size_ - sizeof(LogHeader)) / sizeof(LogRecord);
+}
+
+TransactionLogReader::~TransactionLogReader()
+{
+    ::munmap(mapping_, mapping_size_);
+}
+
+size_t Banking::recover(AccountStore& store, const string& log_path, size_t no_of_threads)
+{
+    TransactionLogReader log{log_path};
+
+    return store.replay(log.begin(), log.size(), no_of_threads);
+}
@@ -0,0 +1,145 @@
+#ifndef TRANSACTION_LOG_HPP
+#define TRANSACTION_LOG_HPP
+
+#include "transaction.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/types.h>
+
+namespace Banking
+{
+    class AccountStore;
+
+    // Binary write-ahead log of transactions:
+    //   LogHeader | LogRecord | LogRecord | ...
+    // Records have a fixed size - incomplete record at the end of the file (torn write) is ignored.
+    struct LogHeader
+    {
+        char magic[4];
+        uint32_t version;
+        uint64_t reserved;
+    };
+
+    struct LogRecord
+    {
+        int32_t account_id;
+        TransactionType type;
+        char padding[3];
+        int64_t amount; // Money::units()
+    };
+
+    static_assert(sizeof(LogHeader) == 16 && sizeof(LogRecord) == 16, "Log format must not depend on padding");
+
+    // Group commit - pending records are written & synced (fdatasync) by the flusher thread when
+    // max_pending_records is reached or max_delay elapsed since the oldest pending record
+    struct GroupCommit
+    {
+        size_t max_pending_records = 4096;
+        std::chrono::milliseconds max_delay{10};
+    };
+
+    enum class Durability
+    {
+        deferred, // append returns at once - record is committed by the next group commit
+        synced    // append returns when the record is written & synced
+    };
+
+    class TransactionLogWriter
+    {
+    public:
+        explicit TransactionLogWriter(const std::string& path, GroupCommit group_commit = GroupCommit{});
+
+        TransactionLogWriter(const TransactionLogWriter&) = delete;
+        TransactionLogWriter& operator=(const TransactionLogWriter&) = delete;
+
+        // commits pending records
+        ~TransactionLogWriter();
+
+        // record becomes durable with the next group commit; synced append commits the pending batch
+        // without waiting for max_delay & throws the error of the commit when it fails
+        void append(int account_id, const Transaction& t, Durability durability = Durability::deferred);
+
+        // writes & syncs pending records immediately; when writing or syncing fails the file is
+        // truncated to the last commit and the batch stays pending - it is retried by the next commit
+        void commit();
+
+        // number of records written & synced to the disk
+        uint64_t committed() const
+        {
+            return committed_.load(std::memory_order_acquire);
+        }
+
+    private:
+        void run_flusher();
+
+        const GroupCommit group_commit_;
+        int fd_;
+        off_t committed_size_; // size of the file with committed records - guarded by mtx_io_
+        bool failed_ = false;  // file could not be restored after a failed commit
+        std::vector<LogRecord> pending_;
+        std::mutex mtx_pending_;
+        std::mutex mtx_io_; // orders writes of batches
+        std::condition_variable cv_pending_;
+        std::condition_variable cv_committed_;
+        std::atomic<uint64_t> committed_{0};
+        uint64_t appended_ = 0;       // guarded by mtx_pending_ as the rest of the state below
+        uint64_t failed_commits_ = 0;
+        std::exception_ptr last_error_;
+        bool sync_requested_ = false;
+        bool done_ = false;
+        std::thread flusher_;
+    };
+
+    // Read-only view of the log mapped into memory
+    class TransactionLogReader
+    {
+    public:
+        explicit TransactionLogReader(const std::string& path);
+
+        TransactionLogReader(const TransactionLogReader&) = delete;
+        TransactionLogReader& operator=(const TransactionLogReader&) = delete;
+
+        ~TransactionLogReader();
+
+        size_t size() const
+        {
+            return size_;
+        }
+
+        const LogRecord* begin() const
+        {
+            return records_;
+        }
+
+        const LogRecord* end() const
+        {
+            return records_ + size_;
+        }
+
+        const LogRecord& operator[](size_t index) const
+        {
+            return records_[index];
+        }
+
+    private:
+        void* mapping_ = nullptr;
+        size_t mapping_size_ = 0;
+        const LogRecord* records_ = nullptr;
+        size_t size_ = 0;
+    };
+
+    // replays the log on accounts of the store (created with their opening balances) -
+    // returns number of replayed records; records of accounts missing in the store are skipped
+    size_t recover(AccountStore& store, const std::string& log_path,
+                 size_t no_of_threads = std::thread::hardware_concurrency());
+}
+
+#endif // TRANSACTION_LOG_HPP
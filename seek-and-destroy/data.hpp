@@ -0,0 +1,58 @@
+#ifndef DATA_HPP
+#define DATA_HPP
+
+#include "mvector.hpp"
+#include <memory_resource>
+#include <numeric>
+#include <string>
+#include <utility>
+
+class Data
+{
+    std::string name_;
+    MVector data_;
+
+public:
+    Data() = default;
+
+    Data(const std::string& name, size_t size,
+         std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : name_(name),
+          data_(MVector::generate(size, [](size_t i) { return static_cast<int>(i * i); },
+                                  default_thread_pool(), resource))
+    {}
+
+    template <typename TGenerator>
+    static Data generate(const std::string& name, size_t size, TGenerator generator,
+                         std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+    {
+        return Data{name, MVector::generate(size, std::move(generator), default_thread_pool(), resource)};
+    }
+
+    Data(const std::string& name, MVector data)
+        : name_(name), data_(std::move(data))
+    {}
+
+    const std::string& name() const
+    {
+        return name_;
+    }
+
+    const MVector& data() const
+    {
+        return data_;
+    }
+
+    template <typename TFunction>
+    void transform(TFunction f)
+    {
+        data_.transform(std::move(f));
+    }
+
+    int sum() const
+    {
+        return std::accumulate(data_.begin(), data_.end(), 0);
+    }
+};
+
+#endif // DATA_HPP
@@ -0,0 +1,121 @@
+#include "data_file.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <utility>
+
+using namespace std;
+
+namespace
+{
+    size_t align_up(size_t offset, size_t alignment)
+    {
+        return (offset + alignment - 1) / alignment * alignment;
+    }
+
+    DataFile::Header parse_header(const MappedFile& file)
+    {
+        using namespace DataFile;
+
+        Header header;
+
+        if (file.size() < sizeof(Header))
+            throw FormatError("File is too small to contain a header");
+
+        memcpy(&header, file.data(), sizeof(Header));
+
+        if (!equal(begin(header.magic), end(header.magic), begin(magic)))
+            throw FormatError("Invalid magic number");
+
+        if (header.version != version)
+            throw FormatError("Unsupported version: " + to_string(header.version));
+
+        if (header.element_type != static_cast<uint16_t>(ElementType::int32) || header.element_size != sizeof(int))
+            throw FormatError("Unsupported element type");
+
+        if (header.payload_offset < sizeof(Header) + header.name_length
+            || header.payload_offset % payload_alignment != 0
+            || header.payload_offset > file.size()
+            || header.count > (file.size() - header.payload_offset) / sizeof(int))
+            throw FormatError("Payload exceeds size of the file");
+
+        return header;
+    }
+
+    pair<string, MVector> load_file(const string& path, MapMode mode, DataFile::Checksum checksum)
+    {
+        MappedFile file{path, mode};
+        const DataFile::Header header = parse_header(file);
+
+        string name(static_cast<const char*>(file.data()) + sizeof(DataFile::Header), header.name_length);
+        MVector items{move(file), header.payload_offset, header.count};
+
+        if (checksum == DataFile::Checksum::verify
+            && DataFile::checksum(items.cbegin(), items.size()) != header.checksum)
+            throw DataFile::FormatError("Checksum mismatch: " + path);
+
+        return make_pair(move(name), move(items));
+    }
+}
+
+uint64_t DataFile::checksum(const int* items, size_t count)
+{
+    uint64_t hash = 14695981039346656037ull;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        hash ^= static_cast<uint32_t>(items[i]);
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
+}
+
+void DataFile::save(const string& path, const MVector& items, const string& name)
+{
+    Header header{};
+    copy(begin(magic), end(magic), header.magic);
+    header.version = version;
+    header.element_type = static_cast<uint16_t>(ElementType::int32);
+    header.element_size = sizeof(int);
+    header.name_length = static_cast<uint32_t>(name.size());
+    header.count = items.size();
+    header.payload_offset = align_up(sizeof(Header) + name.size(), payload_alignment);
+    header.checksum = checksum(items.begin(), items.size());
+
+    ofstream file_out{path, ios::binary | ios::trunc};
+    if (!file_out)
+        throw runtime_error("Cannot open file for writing: " + path);
+
+    const char padding[payload_alignment] = {};
+
+    file_out.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+    file_out.write(name.data(), name.size());
+    file_out.write(padding, header.payload_offset - sizeof(Header) - name.size());
+    file_out.write(reinterpret_cast<const char*>(items.begin()), items.size() * sizeof(int));
+
+    if (!file_out.flush())
+        throw runtime_error("Write error: " + path);
+}
+
+void DataFile::save(const string& path, const Data& ds)
+{
+    save(path, ds.data(), ds.name());
+}
+
+DataFile::Header DataFile::read_header(const string& path)
+{
+    return parse_header(MappedFile{path, MapMode::read_only});
+}
+
+MVector DataFile::load_items(const string& path, MapMode mode, Checksum checksum)
+{
+    return load_file(path, mode, checksum).second;
+}
+
+Data DataFile::load(const string& path, MapMode mode, Checksum checksum)
+{
+    auto content = load_file(path, mode, checksum);
+
+    return Data{content.first, move(content.second)};
+}
@@ -0,0 +1,69 @@
+#ifndef DATA_FILE_HPP
+#define DATA_FILE_HPP
+
+#include "data.hpp"
+#include "mapped_file.hpp"
+#include "mvector.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+// Binary format of Data & MVector:
+//   Header | name (name_length bytes) | padding | payload (count items)
+// Payload is aligned to payload_alignment, so it can be mapped directly
+// as MVector storage (zero-copy load).
+namespace DataFile
+{
+    constexpr char magic[4] = {'M', 'V', 'E', 'C'};
+    constexpr uint16_t version = 1;
+    constexpr size_t payload_alignment = 64;
+
+    enum class ElementType : uint16_t
+    {
+        int32 = 1
+    };
+
+    enum class Checksum
+    {
+        skip, verify
+    };
+
+    struct Header
+    {
+        char magic[4];
+        uint16_t version;
+        uint16_t element_type;
+        uint32_t element_size;
+        uint32_t name_length;
+        uint64_t count;
+        uint64_t payload_offset;
+        uint64_t checksum;
+    };
+
+    static_assert(sizeof(Header) == 40, "Header must not contain padding");
+
+    class FormatError : public std::runtime_error
+    {
+    public:
+        using std::runtime_error::runtime_error;
+    };
+
+    // FNV-1a calculated for items of the payload
+    uint64_t checksum(const int* items, size_t count);
+
+    void save(const std::string& path, const MVector& items, const std::string& name = "");
+
+    void save(const std::string& path, const Data& ds);
+
+    Header read_header(const std::string& path);
+
+    // items are not copied - payload of the file is mapped into memory
+    MVector load_items(const std::string& path, MapMode mode = MapMode::read_only,
+                       Checksum checksum = Checksum::skip);
+
+    Data load(const std::string& path, MapMode mode = MapMode::read_only,
+              Checksum checksum = Checksum::skip);
+}
+
+#endif // DATA_FILE_HPP
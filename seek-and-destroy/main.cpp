@@ -1,7 +1,16 @@
 #define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
 #include "catch.hpp"
+#include "data.hpp"
+#include "data_file.hpp"
+#include "memory_resources.hpp"
+#include "mvector.hpp"
+#include <cstdio>
+#include <fstream>
 #include <iostream>
+#include <numeric>
 #include <string>
+#include <thread>
 #include <vector>
 
 using namespace std::literals;
@@ -16,211 +25,170 @@ void print(const std::string& desc, const TContainer& vec)
     std::cout << "\n";
 }
 
-class MVector
+TEST_CASE("MVector")
 {
-public:
-    typedef int* iterator;
-    typedef const int* const_iterator;
+    SECTION("construction with size")
+    {
+        MVector vec(5);
 
-    // default constructor
-    MVector() : items_{nullptr}, size_{0}
-    {}
+        REQUIRE(vec.size() == 5);
 
-    MVector(size_t size)
-        : items_{new int[size]}, size_{size}
-    {
-        std::cout << "MVector(at " << items_ << ")\n";
-        std::fill_n(begin(), size_, 0);
+        REQUIRE(std::all_of(vec.begin(), vec.end(), [](int x) { return x == 0; }));
     }
 
-    MVector(std::initializer_list<int> lst)
-        : items_{new int[lst.size()]}, size_{lst.size()}
+    SECTION("construction with list")
     {
-        std::cout << "MVector(at " << items_ << ")\n";
-        std::copy(lst.begin(), lst.end(), items_);
-    }
+        MVector vec = {1, 2, 3, 4, 5};
 
-    // copy constructor
-    MVector(const MVector& source)
-        : items_{new int[source.size()]}, size_{source.size()}
-    {
-        std::cout << "MVector(cc from " << source.items_ << " to " << items_ << ")\n";
-        std::copy(source.begin(), source.end(), items_);
+        REQUIRE(vec.size() == 5);
+        REQUIRE(vec[1] == 2);
+        REQUIRE(vec[4] == 5);
     }
 
-    // copy assignment
-    MVector& operator=(const MVector& source)
-    {
-        if (this != &source) // check for self-assignment
-        {
-            std::cout << "MVector operator=(cpy: " << items_ << ")\n";
-            delete[] items_;  // clean-up old state
-
-            // copy
-            items_ = new int[source.size()];
-            size_ = source.size();
-            std::copy(source.begin(), source.end(), items_);
-        }
+    SECTION("indexing")
+    {        
+        MVector vec(10);
 
-        return *this;
-    }
+        vec[0] = 1;
+        REQUIRE(vec[0] == 1);
 
-    // move constructor
-    MVector(MVector&& source) : items_{source.items_}, size_{source.size_}
-    {
-        std::cout << "MVector(mv " << items_ << ")\n";
-        source.items_ = nullptr;
-        source.size_ = 0;
+        print("vec", vec);
     }
 
-    // move assignment
-    MVector& operator=(MVector&& source)
+    SECTION("copying")
     {
-        if (this != &source)
-        {
-            std::cout << "MVector operator=(mov: " << items_ << ")\n";
-            delete[] items_;
+        MVector vec1 = {1, 2, 3, 4, 5};
+        MVector vec2 = vec1; // copy constructor
 
-            items_ = source.items_;
-            size_ = source.size_;
+        REQUIRE(vec2[3] == 4);
 
-            source.items_ = nullptr;
-            source.size_ = 0;
-        }
+        MVector vec3 = {6, 6, 5};
+        vec2 = vec3; // copy assignment
 
-        return *this;
+        vec3 = vec3;
     }
 
-    ~MVector() noexcept // destructor
+    SECTION("copy-on-write")
     {
-        std::cout << "~MVector(at " << items_ << ")\n";
-
-        try
-        {
-            may_throw();
-        }
-        catch(...)
-        {
-            // Logging exception
-        }
+        const MVector vec1 = {1, 2, 3, 4, 5};
+        MVector vec2 = vec1;
 
-        delete[] items_;
-    }
+        REQUIRE(vec1.is_shared());
+        REQUIRE(vec2.cbegin() == vec1.cbegin()); // no deep copy
 
-    size_t size() const
-    {
-        return size_;
-    }
+        vec2[0] = 665; // first mutation duplicates the buffer
 
-    iterator begin()
-    {
-        return items_;
+        REQUIRE(vec2.cbegin() != vec1.cbegin());
+        REQUIRE_FALSE(vec1.is_shared());
+        REQUIRE_FALSE(vec2.is_shared());
+        REQUIRE(vec1[0] == 1);
+        REQUIRE(vec2[0] == 665);
     }
 
-    const_iterator begin() const
+    SECTION("moving")
     {
-        return items_;
-    }
+        MVector vec1 = {1, 2, 3, 4, 5};
+        MVector vec2 = std::move(vec1); // move construct
 
-    iterator end()
-    {
-        return items_ + size_;
-    }
+        REQUIRE(vec2.size() == 5);
+        REQUIRE(vec2[1] == 2);
+        REQUIRE(vec1.size() == 0);
 
-    const_iterator end() const
-    {
-        return items_ + size_;
+        vec1 = std::move(vec2); // move assigment
     }
+}
 
-    int& operator[](size_t index)
-    {
-        return items_[index];
-    }
+void write_items(const std::string& path, const std::vector<int>& items)
+{
+    std::ofstream file_out{path, std::ios::binary | std::ios::trunc};
+    file_out.write(reinterpret_cast<const char*>(items.data()), items.size() * sizeof(int));
+}
 
-    const int& operator[](size_t index) const
-    {        
-        return items_[index];
-    }
+TEST_CASE("MVector - mapped file")
+{
+    const std::string path = "mvector_mapped.bin";
+    write_items(path, {1, 2, 3, 4, 5});
 
-    int& at(size_t index)
+    SECTION("read-only")
     {
-        if (index >= size_)
-            throw std::out_of_range("Index out of valid range");
+        const MVector vec{MappedFile{path, MapMode::read_only}};
+        vec.advise(AccessHint::sequential);
 
-        return items_[index];
+        REQUIRE(vec.is_mapped());
+        REQUIRE_FALSE(vec.is_writable());
+        REQUIRE(vec.size() == 5);
+        REQUIRE(vec[1] == 2);
+        REQUIRE(std::accumulate(vec.begin(), vec.end(), 0) == 15);
     }
 
-    const int& at(size_t index) const
+    SECTION("copy-on-write")
     {
-        if (index >= size_)
-            throw std::out_of_range("Index out of valid range");
+        MVector vec{MappedFile{path, MapMode::copy_on_write}};
+        vec.advise(AccessHint::random);
 
-        return items_[index];
-    }
-private:
-    int* items_;
-    size_t size_;
+        vec[0] = 665;
+        REQUIRE(vec[0] == 665);
 
-    void may_throw()
-    {
-        throw std::logic_error("WTF");
+        MVector other{MappedFile{path, MapMode::read_only}};
+        REQUIRE(other[0] == 1); // file is not modified
     }
-};
 
-TEST_CASE("MVector")
-{
-    SECTION("construction with size")
+    SECTION("range of items")
     {
-        MVector vec(5);
+        MVector vec{MappedFile{path, MapMode::read_only}, 2 * sizeof(int), 3};
 
-        REQUIRE(vec.size() == 5);
+        REQUIRE(vec.size() == 3);
+        REQUIRE(vec[0] == 3);
 
-        REQUIRE(std::all_of(vec.begin(), vec.end(), [](int x) { return x == 0; }));
+        REQUIRE_THROWS_AS((MVector{MappedFile{path, MapMode::read_only}, sizeof(int), 5}), std::out_of_range);
     }
 
-    SECTION("construction with list")
+    SECTION("copy shares mapping")
     {
-        MVector vec = {1, 2, 3, 4, 5};
+        const MVector vec{MappedFile{path, MapMode::read_only}};
+        MVector copy = vec;
 
-        REQUIRE(vec.size() == 5);
-        REQUIRE(vec[1] == 2);
+        REQUIRE(copy.is_mapped());
+
+        copy[4] = 6; // items are copied to the heap
+        REQUIRE_FALSE(copy.is_mapped());
         REQUIRE(vec[4] == 5);
     }
 
-    SECTION("indexing")
-    {        
-        MVector vec(10);
+    SECTION("writing to read-only mapping")
+    {
+        MVector vec{MappedFile{path, MapMode::read_only}};
 
-        vec[0] = 1;
-        REQUIRE(vec[0] == 1);
+        vec[0] = 665;
 
-        print("vec", vec);
+        REQUIRE(vec.is_mapped()); // private mapping - only the written page is copied
+        REQUIRE(vec[0] == 665);
+
+        MVector other{MappedFile{path, MapMode::read_only}};
+        REQUIRE(other[0] == 1); // file is not modified
     }
 
-    SECTION("copying")
+    SECTION("non-const reads of read-only mapping do not copy")
     {
-        MVector vec1 = {1, 2, 3, 4, 5};
-        MVector vec2 = vec1; // copy constructor
+        Memory::Budget budget{"mapped", 1'000'000};
+        MVector vec{MappedFile{path, MapMode::read_only}, &budget};
 
-        REQUIRE(vec2[3] == 4);
+        int sum = 0;
+        for (int& item : vec)
+            sum += item;
+        sum += vec[0] + vec.at(4);
 
-        MVector vec3 = {6, 6, 5};
-        vec2 = vec3; // copy assignment
-
-        vec3 = vec3;
+        REQUIRE(sum == 15 + 1 + 5);
+        REQUIRE(vec.is_mapped());
+        REQUIRE(budget.allocations() == 0);
     }
 
-    SECTION("moving")
+    SECTION("missing file")
     {
-        MVector vec1 = {1, 2, 3, 4, 5};
-        MVector vec2 = std::move(vec1); // move construct
-
-        REQUIRE(vec2.size() == 5);
-        REQUIRE(vec2[1] == 2);
-        REQUIRE(vec1.size() == 0);
-
-        vec1 = std::move(vec2); // move assigment
+        REQUIRE_THROWS_AS((MappedFile{"not_existing.bin", MapMode::read_only}), std::system_error);
     }
+
+    std::remove(path.c_str());
 }
 
 TEST_CASE("dynamic memory allocation")
@@ -255,45 +223,125 @@ TEST_CASE("dynamic memory allocation")
     }
 }
 
-class Data
+TEST_CASE("Data")
 {
-    std::string name_;
-    MVector data_;
+    std::cout << "\n+++++++++++++++++++++++++++++++\n";
 
-public:
-    Data() = default;
+    Data ds1{"ds1", 10};
 
-    Data(const std::string& name, size_t size)
-        : name_(name), data_(size)
+    print("ds1", ds1.data());
+    std::cout << "Sum: " << ds1.sum() << "\n";
+
+    Data ds2 = ds1; // copy constructor
+    Data ds3 = std::move(ds2); // move constructor
+
+    Data ds4;
+}
+
+TEST_CASE("Data - shared snapshots")
+{
+    Data ds{"enterprise", 1'000'000};
+
+    Data snapshot = ds; // O(1) - buffer is shared
+    REQUIRE(snapshot.data().cbegin() == ds.data().cbegin());
+
+    std::vector<int> sums(4);
+    std::vector<std::thread> readers;
+    for (size_t i = 0; i < sums.size(); ++i)
+        readers.emplace_back([snapshot, &sums, i] { sums[i] = snapshot.sum(); });
+
+    for (auto& thd : readers)
+        thd.join();
+
+    REQUIRE(std::all_of(sums.begin(), sums.end(), [&ds](int s) { return s == ds.sum(); }));
+}
+
+TEST_CASE("Data - parallel construction")
+{
+    const size_t size = 1'000'000;
+
+    Data ds{"vulcan", size};
+    REQUIRE(ds.data()[size - 1] == static_cast<int>((size - 1) * (size - 1)));
+
+    ThreadPool pool{4};
+    MVector vec = MVector::generate(size, [](size_t i) { return static_cast<int>(i % 7); }, pool);
+    REQUIRE(vec[size - 1] == static_cast<int>((size - 1) % 7));
+
+    vec.transform([](int x) { return x * 2; }, pool);
+    REQUIRE(vec[6] == 12);
+
+    Data generated = Data::generate("ones", size, [](size_t) { return 1; });
+    generated.transform([](int x) { return x + 1; });
+    REQUIRE(generated.sum() == 2 * static_cast<int>(size));
+
+    SECTION("exception thrown by generator")
     {
-        for(size_t i = 0; i < data_.size(); ++i)
-            data_[i] = i * i;
+        REQUIRE_THROWS_AS(MVector::generate(size, [](size_t i) -> int {
+            if (i == 999'999)
+                throw std::runtime_error("generator failed");
+            return 0;
+        }, pool), std::runtime_error);
     }
+}
 
-    const MVector& data() const
+TEST_CASE("Data - binary file")
+{
+    const std::string path = "data_file.bin";
+
+    Data ds{"spock", 100};
+    DataFile::save(path, ds);
+
+    SECTION("header")
     {
-        return data_;
+        DataFile::Header header = DataFile::read_header(path);
+
+        REQUIRE(header.version == DataFile::version);
+        REQUIRE(header.count == 100);
+        REQUIRE(header.name_length == 5);
+        REQUIRE(header.payload_offset % DataFile::payload_alignment == 0);
+        REQUIRE(header.checksum == DataFile::checksum(ds.data().begin(), ds.data().size()));
     }
 
-    int sum() const
+    SECTION("zero-copy load")
     {
-        return std::accumulate(data_.begin(), data_.end(), 0);
+        Data loaded = DataFile::load(path, MapMode::read_only, DataFile::Checksum::verify);
+
+        REQUIRE(loaded.name() == "spock");
+        REQUIRE(loaded.data().is_mapped());
+        REQUIRE(std::equal(loaded.data().begin(), loaded.data().end(), ds.data().begin(), ds.data().end()));
+        REQUIRE(loaded.sum() == ds.sum());
     }
-};
 
-TEST_CASE("Data")
-{
-    std::cout << "\n+++++++++++++++++++++++++++++++\n";
+    SECTION("MVector only")
+    {
+        DataFile::save(path, MVector{1, 2, 3});
 
-    Data ds1{"ds1", 10};
+        MVector items = DataFile::load_items(path);
 
-    print("ds1", ds1.data());
-    std::cout << "Sum: " << ds1.sum() << "\n";
+        REQUIRE(items.size() == 3);
+        REQUIRE(items[2] == 3);
+    }
 
-    Data ds2 = ds1; // copy constructor
-    Data ds3 = std::move(ds2); // move constructor
+    SECTION("corrupted payload")
+    {
+        {
+            std::fstream file{path, std::ios::binary | std::ios::in | std::ios::out};
+            file.seekp(DataFile::read_header(path).payload_offset);
+            file.write("\xff", 1);
+        }
 
-    Data ds4;
+        REQUIRE_NOTHROW(DataFile::load(path));
+        REQUIRE_THROWS_AS(DataFile::load(path, MapMode::read_only, DataFile::Checksum::verify), DataFile::FormatError);
+    }
+
+    SECTION("not a data file")
+    {
+        write_items(path, std::vector<int>(100, 1));
+
+        REQUIRE_THROWS_AS(DataFile::load(path), DataFile::FormatError);
+    }
+
+    std::remove(path.c_str());
 }
 
 class Nocopyable
@@ -332,6 +380,30 @@ Data load_data()
     return ds;
 }
 
+// items are not read into memory - pages of the file are loaded on demand
+Data load_data(const std::string& name, const std::string& path)
+{
+    MVector items{MappedFile{path, MapMode::read_only}};
+    items.advise(AccessHint::sequential);
+
+    return Data{name, std::move(items)};
+}
+
+TEST_CASE("Data - mapped from file")
+{
+    const std::string path = "data_mapped.bin";
+    write_items(path, {1, 4, 9, 16});
+
+    {
+        Data ds = load_data("mapped", path);
+
+        REQUIRE(ds.data().is_mapped());
+        REQUIRE(ds.sum() == 30);
+    }
+
+    std::remove(path.c_str());
+}
+
 namespace LegacyCpp
 {
     Data* load_data()
@@ -342,6 +414,87 @@ namespace LegacyCpp
     }
 }
 
+namespace WithArena
+{
+    // Data is destroyed together with the arena - no delete is required
+    Data* load_data(Memory::Arena& arena)
+    {
+        Data* ptr_ds = arena.create<Data>("james", 1'000'000, arena.resource());
+
+        return ptr_ds;
+    }
+}
+
+TEST_CASE("memory resources")
+{
+    SECTION("arena")
+    {
+        static int destroyed;
+        destroyed = 0;
+
+        struct Tracked
+        {
+            ~Tracked() { ++destroyed; }
+        };
+
+        Memory::Arena arena;
+
+        Data* ptr_ds = WithArena::load_data(arena);
+        REQUIRE(ptr_ds->data().resource() == arena.resource());
+        REQUIRE(ptr_ds->data()[999] == 999 * 999);
+
+        arena.create<Tracked>();
+        arena.create<Tracked>();
+
+        arena.release(); // all objects are destroyed at once
+        REQUIRE(destroyed == 2);
+    }
+
+    SECTION("fixed-size pool")
+    {
+        Memory::FixedPool pool{64, 16};
+
+        void* ptr1 = pool.allocate(48);
+        void* ptr2 = pool.allocate(64);
+        REQUIRE(ptr1 != ptr2);
+
+        pool.deallocate(ptr1, 48);
+        REQUIRE(pool.allocate(32) == ptr1); // block is reused
+
+        std::pmr::vector<int> vec({1, 2, 3}, &pool);
+        REQUIRE(vec.size() == 3);
+
+        MVector mvec({1, 2, 3}, &pool);
+        REQUIRE(mvec.resource() == &pool);
+    }
+
+    SECTION("thread-local pool")
+    {
+        std::pmr::memory_resource* main_pool = Memory::thread_local_pool();
+        std::pmr::memory_resource* other_pool = nullptr;
+
+        std::thread thd{[&other_pool] {
+            other_pool = Memory::thread_local_pool();
+            MVector vec(100, other_pool);
+            std::pmr::string text{"text that does not fit into small buffer", other_pool};
+        }};
+        thd.join();
+
+        REQUIRE(main_pool == Memory::thread_local_pool());
+        REQUIRE(main_pool != other_pool);
+    }
+
+    SECTION("copy-on-write keeps resource")
+    {
+        Memory::FixedPool pool{256};
+        MVector vec1({1, 2, 3}, &pool);
+        MVector vec2 = vec1;
+
+        vec2[0] = 0;
+        REQUIRE(vec2.resource() == &pool);
+    }
+}
+
 ///////////////////////////////////////////
 // Exceptions
 
@@ -355,6 +508,130 @@ TEST_CASE("Exceptions")
 }
 
 
+TEST_CASE("Exceptions - non-throwing checked access")
+{
+    const MVector vec = {1, 2, 3, 4, 5};
+
+    REQUIRE(vec.try_at(4) == 5);
+    REQUIRE_FALSE(vec.try_at(5).has_value());
+
+    std::vector<size_t> indices = {4, 0, 2};
+    REQUIRE(vec.indices_in_range(indices));
+
+    std::vector<int> values(indices.size());
+    REQUIRE(vec.try_gather(indices, values.data()));
+    REQUIRE(values == (std::vector<int>{5, 1, 3}));
+
+    indices.push_back(5);
+    values.assign(indices.size(), 0);
+    REQUIRE_FALSE(vec.indices_in_range(indices));
+    REQUIRE_FALSE(vec.try_gather(indices, values.data()));
+    REQUIRE(values == (std::vector<int>{0, 0, 0, 0}));
+}
+
+TEST_CASE("Exceptions - checked access benchmark", "[.][benchmark]")
+{
+    const MVector vec = MVector::generate(1'000, [](size_t i) { return static_cast<int>(i); });
+
+    std::vector<size_t> indices(10'000);
+    for (size_t i = 0; i < indices.size(); ++i)
+        indices[i] = (i * 7919) % 2'000; // half of lookups miss
+
+    BENCHMARK("at() - throwing on miss")
+    {
+        long long sum = 0;
+        for (size_t index : indices)
+        {
+            try
+            {
+                sum += vec.at(index);
+            }
+            catch (const std::out_of_range&)
+            {
+                --sum;
+            }
+        }
+        return sum;
+    };
+
+    BENCHMARK("try_at() - optional")
+    {
+        long long sum = 0;
+        for (size_t index : indices)
+        {
+            if (auto value = vec.try_at(index))
+                sum += *value;
+            else
+                --sum;
+        }
+        return sum;
+    };
+
+    std::vector<size_t> valid_indices(10'000);
+    for (size_t i = 0; i < valid_indices.size(); ++i)
+        valid_indices[i] = (i * 7919) % vec.size();
+
+    std::vector<int> values(valid_indices.size());
+
+    BENCHMARK("at() - per index check")
+    {
+        for (size_t i = 0; i < valid_indices.size(); ++i)
+            values[i] = vec.at(valid_indices[i]);
+        return values.back();
+    };
+
+    BENCHMARK("try_gather() - batch check")
+    {
+        vec.try_gather(valid_indices, values.data());
+        return values.back();
+    };
+}
+
+TEST_CASE("Exceptions - memory budget")
+{
+    Memory::Budget budget{"datasets", 1'000'000};
+
+    SECTION("huge request fails fast")
+    {
+        REQUIRE_THROWS_AS(MVector(1'000'000'000'000, &budget), Memory::BudgetExceeded);
+        REQUIRE_THROWS_AS(MVector(1'000'000'000'000, &budget), std::bad_alloc);
+        REQUIRE(budget.failures() == 2);
+        REQUIRE(budget.current() == 0);
+    }
+
+    SECTION("usage counters")
+    {
+        {
+            MVector vec1(1'000, &budget);
+            MVector vec2(1'000, &budget);
+
+            REQUIRE(budget.current() >= 2 * 1'000 * sizeof(int));
+            REQUIRE(budget.allocations() == 2);
+        }
+
+        REQUIRE(budget.current() == 0);
+        REQUIRE(budget.peak() >= 2 * 1'000 * sizeof(int));
+    }
+
+    SECTION("spill to temporary file")
+    {
+        MVector in_memory = MVector::allocate_or_spill(1'000, &budget);
+        REQUIRE_FALSE(in_memory.is_mapped());
+
+        Data ds{"spilled", MVector::allocate_or_spill(1'000'000, &budget)};
+        REQUIRE(ds.data().is_mapped());
+        REQUIRE(ds.data().is_writable());
+        REQUIRE(ds.sum() == 0);
+
+        ds.transform([](int) { return 1; });
+        REQUIRE(ds.data().is_mapped()); // no copy on write
+        REQUIRE(ds.sum() == 1'000'000);
+
+        Data copy = ds; // items are shared - copy on write is allocated from the budget
+        REQUIRE_THROWS_AS(copy.transform([](int) { return 2; }), Memory::BudgetExceeded);
+    }
+}
+
 TEST_CASE("Exceptions - throw & catch")
 {
     try
@@ -0,0 +1,172 @@
+#include "mapped_file.hpp"
+#include <cerrno>
+#include <cstdlib>
+#include <system_error>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace
+{
+    [[noreturn]] void throw_system_error(const string& what)
+    {
+        throw system_error(errno, generic_category(), what);
+    }
+
+    [[noreturn]] void close_and_throw(int fd, const string& what)
+    {
+        const int error = errno; // close() may overwrite errno
+        ::close(fd);
+        throw system_error(error, generic_category(), what);
+    }
+
+    int to_madvise_flag(AccessHint hint)
+    {
+        switch (hint)
+        {
+            case AccessHint::sequential:
+                return MADV_SEQUENTIAL;
+            case AccessHint::random:
+                return MADV_RANDOM;
+            case AccessHint::will_need:
+                return MADV_WILLNEED;
+            case AccessHint::dont_need:
+                return MADV_DONTNEED;
+            default:
+                return MADV_NORMAL;
+        }
+    }
+}
+
+MappedFile::MappedFile(const string& path, MapMode mode)
+    : mode_{mode}
+{
+    int fd = ::open(path.c_str(), (mode == MapMode::read_write) ? O_RDWR : O_RDONLY);
+    if (fd == -1)
+        throw_system_error("open: " + path);
+
+    struct stat file_stat;
+    if (::fstat(fd, &file_stat) == -1)
+        close_and_throw(fd, "fstat: " + path);
+
+    map(fd, static_cast<size_t>(file_stat.st_size), path);
+}
+
+MappedFile MappedFile::create_temporary(size_t size, const string& directory)
+{
+    string dir = directory;
+    if (dir.empty())
+    {
+        const char* tmp_dir = getenv("TMPDIR");
+        dir = (tmp_dir != nullptr && *tmp_dir != '\0') ? tmp_dir : "/tmp";
+    }
+
+    string path = dir + "/mvector-XXXXXX";
+    int fd = ::mkstemp(&path[0]);
+    if (fd == -1)
+        throw_system_error("mkstemp: " + path);
+
+    ::unlink(path.c_str()); // file is removed when the mapping is released
+
+    if (::ftruncate(fd, static_cast<off_t>(size)) == -1)
+        close_and_throw(fd, "ftruncate: " + path);
+
+    MappedFile file;
+    file.mode_ = MapMode::read_write;
+    file.map(fd, size, path);
+
+    return file;
+}
+
+MappedFile::MappedFile(MappedFile&& source) noexcept
+    : data_{source.data_}, size_{source.size_}, mode_{source.mode_}
+{
+    source.data_ = nullptr;
+    source.size_ = 0;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& source) noexcept
+{
+    if (this != &source)
+    {
+        unmap();
+
+        data_ = source.data_;
+        size_ = source.size_;
+        mode_ = source.mode_;
+
+        source.data_ = nullptr;
+        source.size_ = 0;
+    }
+
+    return *this;
+}
+
+MappedFile::~MappedFile() noexcept
+{
+    unmap();
+}
+
+void MappedFile::enable_copy_on_write()
+{
+    if (mode_ != MapMode::read_only)
+        return;
+
+    if (data_ != nullptr && ::mprotect(data_, size_, PROT_READ | PROT_WRITE) == -1)
+        throw_system_error("mprotect");
+
+    mode_ = MapMode::copy_on_write;
+}
+
+void MappedFile::advise(AccessHint hint) const
+{
+    advise(hint, 0, size_);
+}
+
+void MappedFile::advise(AccessHint hint, size_t offset, size_t length) const
+{
+    if (data_ == nullptr || length == 0)
+        return;
+
+    // madvise requires address aligned to the page boundary
+    const size_t page_size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    const size_t aligned_offset = offset - offset % page_size;
+
+    if (::madvise(static_cast<char*>(data_) + aligned_offset, length + (offset - aligned_offset),
+                  to_madvise_flag(hint)) == -1)
+        throw_system_error("madvise");
+}
+
+// takes ownership of fd - descriptor is closed after mapping
+void MappedFile::map(int fd, size_t size, const string& path)
+{
+    if (size > 0) // mmap of zero length is not allowed
+    {
+        const int protection = (mode_ == MapMode::read_only) ? PROT_READ : PROT_READ | PROT_WRITE;
+        // read_only mapping is private - it can be made writable later without reopening the file
+        const int flags = (mode_ == MapMode::read_write) ? MAP_SHARED : MAP_PRIVATE;
+
+        void* addr = ::mmap(nullptr, size, protection, flags, fd, 0);
+        if (addr == MAP_FAILED)
+            close_and_throw(fd, "mmap: " + path);
+
+        data_ = addr;
+        size_ = size;
+    }
+
+    ::close(fd); // mapping stays valid after closing the descriptor
+}
+
+void MappedFile::unmap() noexcept
+{
+    if (data_ != nullptr)
+    {
+        ::munmap(data_, size_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+}
@@ -0,0 +1,83 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <string>
+
+enum class MapMode
+{
+    read_only,     // pages shared with the file, writing is not allowed until enable_copy_on_write()
+    copy_on_write, // pages are private - writes are never stored in the file
+    read_write     // pages shared with the file - writes are stored in the file
+};
+
+enum class AccessHint
+{
+    normal, sequential, random, will_need,
+    dont_need // for copy_on_write mapping drops private modifications of pages
+};
+
+// RAII wrapper for a memory-mapped file (POSIX mmap)
+class MappedFile
+{
+public:
+    MappedFile() = default;
+
+    MappedFile(const std::string& path, MapMode mode);
+
+    // read_write mapping of an anonymous (already unlinked) file of given size filled with zeros;
+    // by default the file is created in $TMPDIR or /tmp
+    static MappedFile create_temporary(size_t size, const std::string& directory = "");
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& source) noexcept;
+    MappedFile& operator=(MappedFile&& source) noexcept;
+
+    ~MappedFile() noexcept;
+
+    explicit operator bool() const
+    {
+        return data_ != nullptr;
+    }
+
+    void* data() const
+    {
+        return data_;
+    }
+
+    size_t size() const
+    {
+        return size_;
+    }
+
+    MapMode mode() const
+    {
+        return mode_;
+    }
+
+    bool writable() const
+    {
+        return mode_ != MapMode::read_only;
+    }
+
+    // read_only mapping becomes copy_on_write (mprotect) - pages are copied by the kernel
+    // only when they are written, nothing is copied up front
+    void enable_copy_on_write();
+
+    // passes a hint to the kernel (madvise) - how pages will be accessed
+    void advise(AccessHint hint) const;
+    void advise(AccessHint hint, size_t offset, size_t length) const;
+
+    void unmap() noexcept;
+
+private:
+    void map(int fd, size_t size, const std::string& path);
+
+    void* data_ = nullptr;
+    size_t size_ = 0;
+    MapMode mode_ = MapMode::read_only;
+};
+
+#endif // MAPPED_FILE_HPP
@@ -0,0 +1,147 @@
+#include "memory_resources.hpp"
+#include <utility>
+
+using namespace std;
+
+namespace
+{
+    size_t align_up(size_t size, size_t alignment)
+    {
+        return (size + alignment - 1) / alignment * alignment;
+    }
+
+    constexpr size_t chunk_header_size = alignof(max_align_t);
+}
+
+void Memory::Arena::release() noexcept
+{
+    for (Finalizer* finalizer = finalizers_; finalizer != nullptr; finalizer = finalizer->next)
+        finalizer->destroy(finalizer->object);
+
+    finalizers_ = nullptr;
+    resource_.release();
+}
+
+Memory::FixedPool::FixedPool(size_t block_size, size_t blocks_per_chunk, pmr::memory_resource* upstream)
+    : block_size_{align_up(max(block_size, sizeof(FreeBlock)), alignof(max_align_t))},
+      blocks_per_chunk_{max<size_t>(blocks_per_chunk, 1)},
+      upstream_{upstream}
+{
+}
+
+void Memory::FixedPool::release() noexcept
+{
+    while (chunks_ != nullptr)
+    {
+        Chunk* next = chunks_->next;
+        upstream_->deallocate(chunks_, chunk_header_size + block_size_ * blocks_per_chunk_, alignof(max_align_t));
+        chunks_ = next;
+    }
+
+    free_list_ = nullptr;
+}
+
+void* Memory::FixedPool::do_allocate(size_t bytes, size_t alignment)
+{
+    if (!fits(bytes, alignment))
+        return upstream_->allocate(bytes, alignment);
+
+    if (free_list_ == nullptr)
+        allocate_chunk();
+
+    FreeBlock* block = free_list_;
+    free_list_ = block->next;
+
+    return block;
+}
+
+void Memory::FixedPool::do_deallocate(void* ptr, size_t bytes, size_t alignment)
+{
+    if (!fits(bytes, alignment))
+    {
+        upstream_->deallocate(ptr, bytes, alignment);
+        return;
+    }
+
+    free_list_ = ::new (ptr) FreeBlock{free_list_};
+}
+
+bool Memory::FixedPool::do_is_equal(const pmr::memory_resource& other) const noexcept
+{
+    return this == &other;
+}
+
+void Memory::FixedPool::allocate_chunk()
+{
+    void* memory = upstream_->allocate(chunk_header_size + block_size_ * blocks_per_chunk_, alignof(max_align_t));
+    chunks_ = ::new (memory) Chunk{chunks_};
+
+    char* blocks = static_cast<char*>(memory) + chunk_header_size;
+    for (size_t i = blocks_per_chunk_; i > 0; --i)
+        free_list_ = ::new (blocks + (i - 1) * block_size_) FreeBlock{free_list_};
+}
+
+Memory::BudgetExceeded::BudgetExceeded(const string& budget_name, size_t requested, size_t available)
+    : message_{"Memory budget '" + budget_name + "' exceeded - requested: " + to_string(requested)
+               + " bytes, available: " + to_string(available) + " bytes"}
+{
+}
+
+Memory::Budget::Budget(string name, size_t limit, pmr::memory_resource* upstream)
+    : name_{move(name)}, limit_{limit}, upstream_{upstream}
+{
+}
+
+void* Memory::Budget::do_allocate(size_t bytes, size_t alignment)
+{
+    // reserve bytes before the allocation - concurrent allocations never exceed the limit
+    size_t used = current_.load(memory_order_relaxed);
+    do
+    {
+        if (bytes > limit_ - used)
+        {
+            failures_.fetch_add(1, memory_order_relaxed);
+            throw BudgetExceeded{name_, bytes, limit_ - used};
+        }
+    } while (!current_.compare_exchange_weak(used, used + bytes, memory_order_relaxed));
+
+    void* ptr;
+    try
+    {
+        ptr = upstream_->allocate(bytes, alignment);
+    }
+    catch (...)
+    {
+        current_.fetch_sub(bytes, memory_order_relaxed);
+        failures_.fetch_add(1, memory_order_relaxed);
+        throw;
+    }
+
+    const size_t now_used = used + bytes;
+    size_t peak = peak_.load(memory_order_relaxed);
+    while (now_used > peak && !peak_.compare_exchange_weak(peak, now_used, memory_order_relaxed))
+    {
+    }
+
+    allocations_.fetch_add(1, memory_order_relaxed);
+
+    return ptr;
+}
+
+void Memory::Budget::do_deallocate(void* ptr, size_t bytes, size_t alignment)
+{
+    upstream_->deallocate(ptr, bytes, alignment);
+    current_.fetch_sub(bytes, memory_order_relaxed);
+}
+
+bool Memory::Budget::do_is_equal(const pmr::memory_resource& other) const noexcept
+{
+    return this == &other;
+}
+
+pmr::memory_resource* Memory::thread_local_pool()
+{
+    thread_local pmr::unsynchronized_pool_resource pool;
+
+    return &pool;
+}
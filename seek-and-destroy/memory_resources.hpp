@@ -0,0 +1,201 @@
+#ifndef MEMORY_RESOURCES_HPP
+#define MEMORY_RESOURCES_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory_resource>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace Memory
+{
+    // Request-scoped arena - memory is obtained by bumping a pointer (monotonic_buffer_resource)
+    // and all objects created in the arena are destroyed at once by release() or destructor
+    class Arena
+    {
+    public:
+        explicit Arena(size_t initial_size = 64 * 1024,
+                       std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+            : resource_{initial_size, upstream}
+        {}
+
+        Arena(const Arena&) = delete;
+        Arena& operator=(const Arena&) = delete;
+
+        ~Arena() noexcept
+        {
+            release();
+        }
+
+        std::pmr::memory_resource* resource()
+        {
+            return &resource_;
+        }
+
+        template <typename T, typename... TArgs>
+        T* create(TArgs&&... args)
+        {
+            void* memory_finalizer = nullptr;
+            if (!std::is_trivially_destructible<T>::value)
+                memory_finalizer = resource_.allocate(sizeof(Finalizer), alignof(Finalizer));
+
+            void* memory = resource_.allocate(sizeof(T), alignof(T));
+            T* object = ::new (memory) T(std::forward<TArgs>(args)...);
+
+            if (memory_finalizer)
+                finalizers_ = ::new (memory_finalizer) Finalizer{&destroy<T>, object, finalizers_};
+
+            return object;
+        }
+
+        // calls destructors of created objects (in reverse order) & frees the whole memory
+        void release() noexcept;
+
+    private:
+        struct Finalizer
+        {
+            void (*destroy)(void*);
+            void* object;
+            Finalizer* next;
+        };
+
+        template <typename T>
+        static void destroy(void* object)
+        {
+            static_cast<T*>(object)->~T();
+        }
+
+        std::pmr::monotonic_buffer_resource resource_;
+        Finalizer* finalizers_ = nullptr;
+    };
+
+    // Pool of fixed-size blocks kept on a free list - blocks are carved from chunks
+    // obtained from the upstream resource. Larger requests are passed to upstream.
+    // Not thread-safe - see thread_local_pool().
+    class FixedPool : public std::pmr::memory_resource
+    {
+    public:
+        explicit FixedPool(size_t block_size, size_t blocks_per_chunk = 1024,
+                           std::pmr::memory_resource* upstream = std::pmr::get_default_resource());
+
+        FixedPool(const FixedPool&) = delete;
+        FixedPool& operator=(const FixedPool&) = delete;
+
+        ~FixedPool() override
+        {
+            release();
+        }
+
+        size_t block_size() const
+        {
+            return block_size_;
+        }
+
+        // returns all chunks to upstream - blocks allocated from the pool become invalid
+        void release() noexcept;
+
+    protected:
+        void* do_allocate(size_t bytes, size_t alignment) override;
+        void do_deallocate(void* ptr, size_t bytes, size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+    private:
+        struct FreeBlock
+        {
+            FreeBlock* next;
+        };
+
+        struct Chunk
+        {
+            Chunk* next;
+        };
+
+        bool fits(size_t bytes, size_t alignment) const
+        {
+            return bytes <= block_size_ && alignment <= alignof(std::max_align_t);
+        }
+
+        void allocate_chunk();
+
+        size_t block_size_;
+        size_t blocks_per_chunk_;
+        std::pmr::memory_resource* upstream_;
+        FreeBlock* free_list_ = nullptr;
+        Chunk* chunks_ = nullptr;
+    };
+
+    class BudgetExceeded : public std::bad_alloc
+    {
+        std::string message_;
+    public:
+        BudgetExceeded(const std::string& budget_name, size_t requested, size_t available);
+
+        const char* what() const noexcept override
+        {
+            return message_.c_str();
+        }
+    };
+
+    // Memory budget of a subsystem - allocation exceeding the limit fails fast with BudgetExceeded
+    // (upstream is not asked for memory). Usage is accounted with atomic counters.
+    class Budget : public std::pmr::memory_resource
+    {
+    public:
+        Budget(std::string name, size_t limit,
+               std::pmr::memory_resource* upstream = std::pmr::get_default_resource());
+
+        const std::string& name() const
+        {
+            return name_;
+        }
+
+        size_t limit() const
+        {
+            return limit_;
+        }
+
+        // bytes allocated currently
+        size_t current() const
+        {
+            return current_.load(std::memory_order_relaxed);
+        }
+
+        // the highest value of current()
+        size_t peak() const
+        {
+            return peak_.load(std::memory_order_relaxed);
+        }
+
+        size_t allocations() const
+        {
+            return allocations_.load(std::memory_order_relaxed);
+        }
+
+        size_t failures() const
+        {
+            return failures_.load(std::memory_order_relaxed);
+        }
+
+    protected:
+        void* do_allocate(size_t bytes, size_t alignment) override;
+        void do_deallocate(void* ptr, size_t bytes, size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+    private:
+        std::string name_;
+        size_t limit_;
+        std::pmr::memory_resource* upstream_;
+        std::atomic<size_t> current_{0};
+        std::atomic<size_t> peak_{0};
+        std::atomic<size_t> allocations_{0};
+        std::atomic<size_t> failures_{0};
+    };
+
+    // Pool owned by the calling thread - allocation & deallocation do not need any locking.
+    // Memory must be deallocated by the same thread that allocated it.
+    std::pmr::memory_resource* thread_local_pool();
+}
+
+#endif // MEMORY_RESOURCES_HPP
@@ -0,0 +1,526 @@
+#ifndef MVECTOR_HPP
+#define MVECTOR_HPP
+
+#include "mapped_file.hpp"
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <initializer_list>
+#include <iostream>
+#include <limits>
+#include <memory_resource>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+// Copies of MVector share an immutable buffer (copy-on-write) - the buffer is
+// duplicated on first access through a non-const method (begin(), end(),
+// operator[], at()) when it is shared with other vectors. A read-only mapping
+// owned by a single vector becomes a private (copy-on-write) mapping instead -
+// only pages that are written are copied (by the kernel), reading does not copy.
+// References and iterators obtained from non-const methods are invalidated by
+// copying the vector - use cbegin()/cend() for reading.
+class MVector
+{
+public:
+    typedef int* iterator;
+    typedef const int* const_iterator;
+
+    // default constructor
+    MVector() : items_{nullptr}, size_{0}, buffer_{nullptr}
+    {}
+
+    // items are allocated from resource - by default from the global heap
+    MVector(size_t size, std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : MVector{}
+    {
+        allocate(size, resource);
+        std::cout << "MVector(at " << items_ << ")\n";
+        std::fill_n(items_, size_, 0);
+    }
+
+    MVector(std::initializer_list<int> lst,
+            std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : MVector{}
+    {
+        allocate(lst.size(), resource);
+        std::cout << "MVector(at " << items_ << ")\n";
+        std::copy(lst.begin(), lst.end(), items_);
+    }
+
+    // items are generated in parallel chunks - generator(index) must be thread-safe;
+    // pages are touched first by the worker that fills them (first-touch placement)
+    template <typename TGenerator>
+    static MVector generate(size_t size, TGenerator generator, ThreadPool& pool = default_thread_pool(),
+                            std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+    {
+        MVector vec;
+        vec.allocate(size, resource);
+        std::cout << "MVector(at " << vec.items_ << ")\n";
+
+        int* items = vec.items_;
+        parallel_for(size, [items, &generator](size_t first, size_t last) {
+            for (size_t i = first; i < last; ++i)
+                items[i] = generator(i);
+        }, pool);
+
+        return vec;
+    }
+
+    // when items cannot be allocated from resource (memory budget exceeded, bad_alloc) they are
+    // spilled to a temporary file mapped into memory - in both cases items are set to zero
+    static MVector allocate_or_spill(size_t size,
+                                     std::pmr::memory_resource* resource = std::pmr::get_default_resource(),
+                                     const std::string& spill_directory = "")
+    {
+        try
+        {
+            return MVector(size, resource);
+        }
+        catch (const std::bad_alloc& e)
+        {
+            std::cout << "MVector(spill: " << e.what() << ")\n";
+
+            if (size > std::numeric_limits<size_t>::max() / sizeof(int))
+                throw std::bad_array_new_length();
+
+            return MVector{MappedFile::create_temporary(size * sizeof(int), spill_directory), resource};
+        }
+    }
+
+    // storage backed by a memory-mapped file - items are not copied,
+    // pages are loaded on first access; copies of shared items are allocated from resource
+    explicit MVector(MappedFile file, std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : MVector{}
+    {
+        const size_t count = file.size() / sizeof(int);
+        map(std::move(file), 0, count, resource);
+    }
+
+    // count items starting at offset (in bytes) of the mapped file
+    MVector(MappedFile file, size_t offset, size_t count,
+            std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : MVector{}
+    {
+        map(std::move(file), offset, count, resource);
+    }
+
+    // copy constructor - O(1), buffer is shared with the source
+    MVector(const MVector& source)
+        : items_{source.items_}, size_{source.size_}, buffer_{source.buffer_}
+    {
+        std::cout << "MVector(cc shared " << items_ << ")\n";
+        if (buffer_)
+            buffer_->add_ref();
+    }
+
+    // copy assignment
+    MVector& operator=(const MVector& source)
+    {
+        if (this != &source) // check for self-assignment
+        {
+            std::cout << "MVector operator=(cpy: " << items_ << ")\n";
+
+            if (source.buffer_)
+                source.buffer_->add_ref();
+            release();  // clean-up old state
+
+            // share
+            items_ = source.items_;
+            size_ = source.size_;
+            buffer_ = source.buffer_;
+        }
+
+        return *this;
+    }
+
+    // move constructor
+    MVector(MVector&& source)
+        : items_{source.items_}, size_{source.size_}, buffer_{source.buffer_}
+    {
+        std::cout << "MVector(mv " << items_ << ")\n";
+        source.items_ = nullptr;
+        source.size_ = 0;
+        source.buffer_ = nullptr;
+    }
+
+    // move assignment
+    MVector& operator=(MVector&& source)
+    {
+        if (this != &source)
+        {
+            std::cout << "MVector operator=(mov: " << items_ << ")\n";
+            release();
+
+            items_ = source.items_;
+            size_ = source.size_;
+            buffer_ = source.buffer_;
+
+            source.items_ = nullptr;
+            source.size_ = 0;
+            source.buffer_ = nullptr;
+        }
+
+        return *this;
+    }
+
+    ~MVector() noexcept // destructor
+    {
+        std::cout << "~MVector(at " << items_ << ")\n";
+
+        try
+        {
+            may_throw();
+        }
+        catch(...)
+        {
+            // Logging exception
+        }
+
+        release();
+    }
+
+    size_t size() const
+    {
+        return size_;
+    }
+
+    bool is_mapped() const
+    {
+        return buffer_ && buffer_->is_mapped();
+    }
+
+    std::pmr::memory_resource* resource() const
+    {
+        return buffer_ ? buffer_->resource() : std::pmr::get_default_resource();
+    }
+
+    // false for read-only mapping - first write copies items to the heap
+    bool is_writable() const
+    {
+        return !buffer_ || buffer_->is_writable();
+    }
+
+    bool is_shared() const
+    {
+        return buffer_ && buffer_->is_shared();
+    }
+
+    // items[i] = f(items[i]) in parallel chunks
+    template <typename TFunction>
+    void transform(TFunction f, ThreadPool& pool = default_thread_pool())
+    {
+        detach();
+
+        int* items = items_;
+        parallel_for(size_, [items, &f](size_t first, size_t last) {
+            for (size_t i = first; i < last; ++i)
+                items[i] = f(items[i]);
+        }, pool);
+    }
+
+    // hint for the kernel how the mapped items will be accessed
+    // (no-op for vectors allocated on the heap)
+    void advise(AccessHint hint) const
+    {
+        if (buffer_)
+            buffer_->advise(hint, items_, size_);
+    }
+
+    iterator begin()
+    {
+        detach();
+        return items_;
+    }
+
+    const_iterator begin() const
+    {
+        return items_;
+    }
+
+    iterator end()
+    {
+        detach();
+        return items_ + size_;
+    }
+
+    const_iterator end() const
+    {
+        return items_ + size_;
+    }
+
+    const_iterator cbegin() const
+    {
+        return items_;
+    }
+
+    const_iterator cend() const
+    {
+        return items_ + size_;
+    }
+
+    int& operator[](size_t index)
+    {
+        detach();
+        return items_[index];
+    }
+
+    const int& operator[](size_t index) const
+    {
+        return items_[index];
+    }
+
+    int& at(size_t index)
+    {
+        if (index >= size_)
+            throw std::out_of_range("Index out of valid range");
+
+        detach();
+        return items_[index];
+    }
+
+    const int& at(size_t index) const
+    {
+        if (index >= size_)
+            throw std::out_of_range("Index out of valid range");
+
+        return items_[index];
+    }
+
+    // non-throwing checked access - std::nullopt when index is out of range
+    std::optional<int> try_at(size_t index) const noexcept
+    {
+        if (index >= size_)
+            return std::nullopt;
+
+        return items_[index];
+    }
+
+    // validates the whole batch with a single comparison (max of indices - vectorizable loop)
+    bool indices_in_range(const size_t* indices, size_t count) const noexcept
+    {
+        size_t max_index = 0;
+        for (size_t i = 0; i < count; ++i)
+            max_index = std::max(max_index, indices[i]);
+
+        return count == 0 || max_index < size_;
+    }
+
+    template <typename TIndices>
+    bool indices_in_range(const TIndices& indices) const noexcept
+    {
+        return indices_in_range(indices.data(), indices.size());
+    }
+
+    // out[i] = items[indices[i]] - nothing is written when any index is out of range
+    template <typename TIndices>
+    bool try_gather(const TIndices& indices, int* out) const noexcept
+    {
+        if (!indices_in_range(indices))
+            return false;
+
+        for (size_t i = 0; i < indices.size(); ++i)
+            out[i] = items_[indices[i]];
+
+        return true;
+    }
+
+private:
+    // storage of items with atomic reference counter
+    class Buffer
+    {
+        std::atomic<long> ref_count_{1};
+    protected:
+        virtual ~Buffer() = default;
+
+        virtual void destroy() noexcept = 0;
+    public:
+        void add_ref() noexcept
+        {
+            ref_count_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        void release() noexcept
+        {
+            if (ref_count_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                destroy();
+        }
+
+        bool is_shared() const noexcept
+        {
+            return ref_count_.load(std::memory_order_acquire) > 1;
+        }
+
+        virtual bool is_mapped() const noexcept
+        {
+            return false;
+        }
+
+        virtual bool is_writable() const noexcept
+        {
+            return true;
+        }
+
+        virtual std::pmr::memory_resource* resource() const noexcept
+        {
+            return std::pmr::get_default_resource();
+        }
+
+        virtual void advise(AccessHint /*hint*/, const int* /*items*/, size_t /*count*/) const
+        {}
+
+        // called for the buffer that is not writable and not shared
+        virtual void make_writable()
+        {}
+    };
+
+    // control block & items are allocated as one block from the memory resource
+    class HeapBuffer : public Buffer
+    {
+        std::pmr::memory_resource* resource_;
+        size_t size_;
+
+        HeapBuffer(std::pmr::memory_resource* resource, size_t size)
+            : resource_{resource}, size_{size}
+        {}
+
+        static size_t allocation_size(size_t size)
+        {
+            if (size > (std::numeric_limits<size_t>::max() - sizeof(HeapBuffer)) / sizeof(int))
+                throw std::bad_array_new_length();
+
+            return sizeof(HeapBuffer) + size * sizeof(int);
+        }
+    protected:
+        void destroy() noexcept override
+        {
+            std::pmr::memory_resource* resource = resource_;
+            const size_t bytes = sizeof(HeapBuffer) + size_ * sizeof(int);
+
+            this->~HeapBuffer();
+            resource->deallocate(this, bytes, alignof(HeapBuffer));
+        }
+    public:
+        static HeapBuffer* create(size_t size, std::pmr::memory_resource* resource)
+        {
+            void* memory = resource->allocate(allocation_size(size), alignof(HeapBuffer));
+            return ::new (memory) HeapBuffer(resource, size);
+        }
+
+        std::pmr::memory_resource* resource() const noexcept override
+        {
+            return resource_;
+        }
+
+        int* items() noexcept
+        {
+            return reinterpret_cast<int*>(this + 1);
+        }
+    };
+
+    class MappedBuffer : public Buffer
+    {
+        MappedFile file_;
+        std::pmr::memory_resource* resource_; // for copies of items
+    protected:
+        void destroy() noexcept override
+        {
+            delete this;
+        }
+    public:
+        MappedBuffer(MappedFile file, std::pmr::memory_resource* resource)
+            : file_{std::move(file)}, resource_{resource}
+        {}
+
+        std::pmr::memory_resource* resource() const noexcept override
+        {
+            return resource_;
+        }
+
+        bool is_mapped() const noexcept override
+        {
+            return true;
+        }
+
+        bool is_writable() const noexcept override
+        {
+            return file_.writable();
+        }
+
+        void advise(AccessHint hint, const int* items, size_t count) const override
+        {
+            file_.advise(hint, reinterpret_cast<const char*>(items) - static_cast<const char*>(file_.data()),
+                         count * sizeof(int));
+        }
+
+        void make_writable() override
+        {
+            file_.enable_copy_on_write();
+        }
+    };
+
+    int* items_;
+    size_t size_;
+    Buffer* buffer_;
+
+    void allocate(size_t size, std::pmr::memory_resource* resource)
+    {
+        HeapBuffer* buffer = HeapBuffer::create(size, resource);
+        items_ = buffer->items();
+        size_ = size;
+        buffer_ = buffer;
+    }
+
+    void map(MappedFile file, size_t offset, size_t count, std::pmr::memory_resource* resource)
+    {
+        if (offset % alignof(int) != 0)
+            throw std::invalid_argument("Offset of mapped items is not aligned");
+
+        if (offset > file.size() || count > (file.size() - offset) / sizeof(int))
+            throw std::out_of_range("Mapped items exceed size of the file");
+
+        if (file)
+            items_ = reinterpret_cast<int*>(static_cast<char*>(file.data()) + offset);
+        size_ = count;
+        buffer_ = new MappedBuffer(std::move(file), resource);
+
+        std::cout << "MVector(mapped at " << items_ << ")\n";
+    }
+
+    // makes the buffer exclusively owned & writable - copies items only if the buffer is shared
+    void detach()
+    {
+        if (!buffer_)
+            return;
+
+        if (buffer_->is_shared())
+        {
+            HeapBuffer* buffer = HeapBuffer::create(size_, buffer_->resource());
+            std::copy(items_, items_ + size_, buffer->items());
+            std::cout << "MVector(detach from " << items_ << " to " << buffer->items() << ")\n";
+
+            buffer_->release();
+            items_ = buffer->items();
+            buffer_ = buffer;
+        }
+        else if (!buffer_->is_writable())
+        {
+            buffer_->make_writable(); // read-only mapping - pages are copied by the kernel when written
+        }
+    }
+
+    void release() noexcept
+    {
+        if (buffer_)
+            buffer_->release();
+    }
+
+    void may_throw()
+    {
+        throw std::logic_error("WTF");
+    }
+};
+
+#endif // MVECTOR_HPP
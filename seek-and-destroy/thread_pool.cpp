@@ -0,0 +1,51 @@
+#include "thread_pool.hpp"
+
+using namespace std;
+
+ThreadPool::ThreadPool(size_t no_of_threads)
+{
+    threads_.reserve(no_of_threads);
+
+    for (size_t i = 0; i < no_of_threads; ++i)
+        threads_.emplace_back([this] { run(); });
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        lock_guard<mutex> lk{mtx_tasks_};
+        done_ = true;
+    }
+    cv_tasks_.notify_all();
+
+    for (auto& thd : threads_)
+        thd.join();
+}
+
+void ThreadPool::run()
+{
+    while (true)
+    {
+        function<void()> task;
+
+        {
+            unique_lock<mutex> lk{mtx_tasks_};
+            cv_tasks_.wait(lk, [this] { return done_ || !tasks_.empty(); });
+
+            if (tasks_.empty()) // done_ && no more tasks
+                return;
+
+            task = move(tasks_.front());
+            tasks_.pop();
+        }
+
+        task();
+    }
+}
+
+ThreadPool& default_thread_pool()
+{
+    static ThreadPool pool;
+
+    return pool;
+}
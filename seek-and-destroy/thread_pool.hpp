@@ -0,0 +1,90 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+class ThreadPool
+{
+public:
+    explicit ThreadPool(size_t no_of_threads = std::max(1u, std::thread::hardware_concurrency()));
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // waits for queued tasks
+    ~ThreadPool();
+
+    size_t size() const
+    {
+        return threads_.size();
+    }
+
+    template <typename TTask>
+    std::future<void> submit(TTask task)
+    {
+        auto packaged_task = std::make_shared<std::packaged_task<void()>>(std::move(task));
+        std::future<void> result = packaged_task->get_future();
+
+        {
+            std::lock_guard<std::mutex> lk{mtx_tasks_};
+            tasks_.push([packaged_task] { (*packaged_task)(); });
+        }
+        cv_tasks_.notify_one();
+
+        return result;
+    }
+
+private:
+    void run();
+
+    std::vector<std::thread> threads_;
+    std::queue<std::function<void()>> tasks_;
+    std::mutex mtx_tasks_;
+    std::condition_variable cv_tasks_;
+    bool done_ = false;
+};
+
+ThreadPool& default_thread_pool();
+
+// Calls f(first, last) for consecutive chunks of [0, count) on threads of the pool.
+// Small ranges are processed on the calling thread. Must not be called from a task of the same pool.
+template <typename TFunction>
+void parallel_for(size_t count, TFunction f, ThreadPool& pool = default_thread_pool(),
+                  size_t min_chunk_size = 64 * 1024)
+{
+    const size_t no_of_chunks = std::min(pool.size(), count / std::max<size_t>(min_chunk_size, 1));
+
+    if (no_of_chunks <= 1)
+    {
+        f(size_t{0}, count);
+        return;
+    }
+
+    const size_t chunk_size = (count + no_of_chunks - 1) / no_of_chunks;
+
+    std::vector<std::future<void>> results;
+    results.reserve(no_of_chunks);
+
+    for (size_t first = 0; first < count; first += chunk_size)
+    {
+        const size_t last = std::min(first + chunk_size, count);
+        results.push_back(pool.submit([&f, first, last] { f(first, last); }));
+    }
+
+    for (auto& result : results) // all tasks must finish before f goes out of scope
+        result.wait();
+
+    for (auto& result : results)
+        result.get();
+}
+
+#endif // THREAD_POOL_HPP